@@ -9,6 +9,7 @@ namespace giygas {
         uint32_t max_sets;
         uint32_t uniform_buffer_descriptors;
         uint32_t sampler_descriptors;
+        uint32_t dynamic_uniform_buffer_descriptors;
     };
 
     class DescriptorPool {
@@ -19,6 +19,10 @@ namespace giygas {
     public:
         uint32_t binding_index;
         ShaderStage stages;
+
+        // Dynamic slots are read at an offset given with each draw (see DrawInfo::dynamic_offsets), so one descriptor
+        // set can serve many objects whose uniforms live in the same buffer.
+        bool is_dynamic;
     };
 
     class SamplerDescriptorSlot {
@@ -31,7 +35,12 @@ namespace giygas {
     class UniformBufferDescriptorBinding {
     public:
         uint32_t binding_index;
-        const UniformBuffer *buffer;
+        const GenericUniformBuffer *buffer;
+
+        // Bytes the shader may read from each dynamic offset. Required for dynamic slots, where it must be greater than
+        // zero and within the device's uniform buffer range limit, and the dynamic offset plus the range must stay
+        // within the buffer. Ignored for other slots, which read the whole buffer.
+        uint32_t range;
     };
 
     class SamplerDescriptorBinding {
@@ -65,7 +74,13 @@ namespace giygas {
         virtual bool is_created() const = 0;
         virtual bool has_descriptors() const = 0;
         virtual void create(const DescriptorSetCreateParameters &params) = 0;
+
+        // Like UniformBuffer::set_data(), this writes the set for the next submitted frame, so in low latency mode
+        // Renderer::wait_for_next_frame() must be called first.
         virtual void update(const DescriptorSetUpdateParameters &params) = 0;
+
+        // Count of dynamic uniform buffer slots, each of which needs an offset when drawing.
+        virtual uint32_t dynamic_offset_count() const = 0;
     };
 
 }
\ No newline at end of file
@@ -61,6 +61,8 @@ namespace giygas {
         }
 
         ~Event() {
+            // Handlers added since the last invocation must be told as well.
+            process_ops();
             for (const auto &handler_it : _handlers) {
                 handler_it->_event = nullptr;
             }
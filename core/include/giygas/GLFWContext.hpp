@@ -65,6 +65,10 @@ namespace giygas {
             VkSurfaceKHR *surface
         ) override;
 
+        bool is_headless() const override;
+        VkExtent2D offscreen_extent() const override;
+        uint32_t offscreen_image_count() const override;
+
 #endif // GIYGAS_WITH_VULKAN
 
         //
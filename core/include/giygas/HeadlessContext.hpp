@@ -0,0 +1,78 @@
+#pragma once
+#include <giygas/config.hpp>
+#ifdef GIYGAS_WITH_VULKAN
+#include <giygas/export.h>
+#include "Context.hpp"
+#include "VulkanContext.hpp"
+#include "EventHandler.hpp"
+
+namespace giygas {
+
+    // A context without a window or surface. Renderers created from this context render into an offscreen image ring
+    // instead of a swapchain, which allows the frame loop to run on machines without a display.
+    class GIYGAS_EXPORT HeadlessContext final
+        : public Context
+        , public VulkanContext
+    {
+        uint32_t _width;
+        uint32_t _height;
+        uint32_t _image_count;
+        bool _is_valid;
+        bool _should_close;
+
+        Event<uint32_t, float> _input_changed;
+
+        //
+        // VulkanContext implementation
+        //
+
+        bool initialize_for_vulkan() override;
+
+        const char **get_required_instance_extensions(
+            unsigned int *count
+        ) const override;
+
+        VkResult create_surface(
+            VkInstance instance,
+            VkSurfaceKHR *surface
+        ) override;
+
+        bool is_headless() const override;
+        VkExtent2D offscreen_extent() const override;
+        uint32_t offscreen_image_count() const override;
+
+    public:
+        HeadlessContext();
+        HeadlessContext(const HeadlessContext &) = delete;
+        HeadlessContext &operator=(const HeadlessContext &) = delete;
+        HeadlessContext(HeadlessContext &&) = delete;
+        HeadlessContext &operator=(HeadlessContext &&) = delete;
+        ~HeadlessContext() override = default;
+
+        //
+        // Context implementation
+        //
+
+        bool is_valid() const override;
+        void *cast_to_specific(RendererType type) override;
+        void update() override;
+        bool should_close() const override;
+        uint32_t translate_key(InputKey key) const override;
+        InputKey get_universal_key(uint32_t key) const override;
+        float get_input(uint32_t input) const override;
+        EventHandler<uint32_t, float> input_changed() override;
+
+        //
+        // HeadlessContext implementation
+        //
+
+        // Must be called before the renderer is initialized.
+        void set_size(uint32_t width, uint32_t height);
+        void set_image_count(uint32_t image_count);
+
+        void request_close();
+    };
+
+}
+
+#endif
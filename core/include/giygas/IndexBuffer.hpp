@@ -16,7 +16,10 @@ namespace giygas {
 
     enum IndexBufferCreateFlags {
         IndexBufferCreateFlag_None     = 0,
-        IndexBufferCreateFlag_Writable = 1 << 0
+        IndexBufferCreateFlag_Writable = 1 << 0,
+
+        // Writable buffers only. See VertexBufferCreateFlag_NoShadowCopy.
+        IndexBufferCreateFlag_NoShadowCopy = 1 << 1
     };
 
     class GenericIndexBuffer {
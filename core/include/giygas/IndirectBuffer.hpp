@@ -0,0 +1,43 @@
+#pragma once
+#include <giygas/export.h>
+#include "RendererType.hpp"
+#include <cstdint>
+
+namespace giygas {
+
+    enum IndirectBufferCreateFlags {
+        IndirectBufferCreateFlag_None     = 0,
+        IndirectBufferCreateFlag_Writable = 1 << 0,
+
+        // Writable buffers only. See VertexBufferCreateFlag_NoShadowCopy.
+        IndirectBufferCreateFlag_NoShadowCopy = 1 << 1
+    };
+
+    // Arguments of a single indexed draw, laid out to match what the GPU reads from an indirect buffer.
+    class IndexedIndirectCommand {
+    public:
+        uint32_t index_count;
+        uint32_t instance_count;
+        uint32_t first_index;
+        int32_t vertex_offset;
+        uint32_t first_instance;
+    };
+
+    class GIYGAS_EXPORT IndirectBuffer {
+    public:
+        virtual ~IndirectBuffer() = default;
+        virtual RendererType renderer_type() const = 0;
+        virtual void *cast_to_renderer_specific() = 0;
+
+        // Copies count draw commands to the buffer, starting at index first_command. After the first call, this may
+        // only be called if IndirectBufferCreateFlag_Writable was included in the creation flags.
+        virtual void set_commands(uint32_t first_command, const IndexedIndirectCommand *commands, uint32_t count) = 0;
+
+        virtual bool is_valid() const = 0;
+        virtual bool is_writable() const = 0;
+
+        // Number of commands the buffer holds, one past the last command written by set_commands().
+        virtual uint32_t command_count() const = 0;
+    };
+
+}
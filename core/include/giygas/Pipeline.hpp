@@ -1,8 +1,13 @@
 #pragma once
+#include <cstdint>
+#include <functional>
 #include "PipelineCreateParameters.hpp"
 
 namespace giygas {
 
+    // Called once every pipeline of a batch has been created, with whether each pipeline is valid.
+    typedef std::function<void(const bool *is_valid, uint32_t count)> PipelineBatchCallback;
+
     class Pipeline {
     public:
         virtual ~Pipeline() = default;
@@ -1,7 +1,5 @@
 #pragma once
-#include "Viewport.hpp"
 #include "VertexAttributeLayout.hpp"
-#include "ScissorRange.hpp"
 #include "Shader.hpp"
 #include "DescriptorSet.hpp"
 #include "Framebuffer.hpp"
@@ -67,8 +65,6 @@ namespace giygas {
 
     class PipelineCreateParameters {
     public:
-        Viewport viewport;
-        ScissorRange scissor;
         BlendParameters blend;
         const VertexAttributeLayout* vertex_buffer_layouts;
         size_t vertex_buffer_layout_count;
@@ -0,0 +1,16 @@
+#pragma once
+
+namespace giygas {
+
+    enum class PresentMode {
+        // Wait for vertical blank, queue frames when presenting faster than the display. Always supported.
+        Fifo,
+        // Like Fifo, but a late frame is presented immediately instead of waiting for the next vertical blank.
+        FifoRelaxed,
+        // Wait for vertical blank, replacing the queued frame when presenting faster than the display.
+        Mailbox,
+        // Present immediately, may tear.
+        Immediate
+    };
+
+}
@@ -2,6 +2,8 @@
 #include <giygas/export.h>
 #include "VertexBuffer.hpp"
 #include "IndexBuffer.hpp"
+#include "IndirectBuffer.hpp"
+#include "StreamBuffer.hpp"
 #include "AttachmentPurpose.hpp"
 #include "PipelineOptions.hpp"
 #include "SamplerParameters.hpp"
@@ -11,19 +13,27 @@
 #include "Sampler.hpp"
 #include "RenderPass.hpp"
 #include "submission.hpp"
+#include "RendererInitParameters.hpp"
+#include "SubmissionStats.hpp"
 
 namespace giygas {
 
     class GIYGAS_EXPORT Renderer {
     public:
         virtual ~Renderer() = default;
-        virtual void initialize() = 0;
+        virtual void initialize(const RendererInitParameters &params) = 0;
+        void initialize() { initialize(RendererInitParameters()); }
         virtual RendererType renderer_type() const = 0;
         virtual VertexBuffer *make_vertex_buffer(VertexBufferCreateFlags flags) = 0;
         virtual IndexBuffer<uint32_t> *make_index_buffer_32(IndexBufferCreateFlags flags) = 0;
         virtual IndexBuffer<uint16_t > *make_index_buffer_16(IndexBufferCreateFlags flags) = 0;
         virtual IndexBuffer<uint8_t> *make_index_buffer_8(IndexBufferCreateFlags flags) = 0;
+        virtual IndirectBuffer *make_indirect_buffer(IndirectBufferCreateFlags flags) = 0;
         virtual UniformBuffer *make_uniform_buffer() = 0;
+
+        // Makes a stream buffer with the given count of bytes available to each frame in flight.
+        virtual StreamBuffer *make_stream_buffer(uint32_t capacity) = 0;
+
         virtual Shader *make_shader() = 0;
         virtual Texture *make_texture() = 0;
         virtual Sampler *make_sampler() = 0;
@@ -33,11 +43,49 @@ namespace giygas {
         virtual Framebuffer *make_framebuffer() = 0;
         virtual Pipeline *make_pipeline() = 0;
 
+        // Creates count pipelines made by make_pipeline(), compiling them in parallel on a pool of worker threads. Same
+        // as calling Pipeline::create() with each params element in turn. is_valid, which may be null, receives whether
+        // each pipeline was created successfully.
+        virtual void create_pipelines(
+            const PipelineCreateParameters *params,
+            Pipeline *const *pipelines,
+            uint32_t count,
+            bool *is_valid
+        ) = 0;
+
+        // Same as create_pipelines(), but returns right away and calls callback from a background thread once every
+        // pipeline is created. The params and pipelines arrays, and everything params refers to, must stay alive
+        // until then, and the pipelines must not be used or destroyed before. The callback may be null.
+        virtual void create_pipelines_async(
+            const PipelineCreateParameters *params,
+            Pipeline *const *pipelines,
+            uint32_t count,
+            PipelineBatchCallback callback
+        ) = 0;
+
         virtual const RenderTarget *swapchain() const = 0;
 
         //virtual uint32_t get_api_texture_format(TextureFormat format) const = 0;
 
         virtual void submit(const PassSubmissionInfo *passes, uint32_t pass_count) = 0;
+
+        // Blocks until the GPU is done with the resources of the next frame. This is done as part of submit() unless
+        // the renderer was initialized in low latency mode, in which case this should be called before game logic
+        // runs, and must be called before writing uniform buffers, updating descriptor sets or allocating from stream
+        // buffers for the next frame. Does nothing when the next frame is already available.
+        virtual void wait_for_next_frame() = 0;
+
+        // Buffer and texture uploads are batched and submitted ahead of the next frame. This submits everything
+        // gathered so far right away instead, for example while loading without rendering frames. Like submit(), this
+        // must be called from the thread submitting frames.
+        virtual void flush_uploads() = 0;
+
+        // Counters gathered while recording the most recent submission.
+        virtual const SubmissionStats &last_submission_stats() const = 0;
+
+        // Writes the pipeline cache to RendererInitParameters::pipeline_cache_path, which otherwise happens when the
+        // renderer is destroyed. Returns false when there is no path or the file could not be written.
+        virtual bool save_pipeline_cache() = 0;
     };
 }
 
@@ -0,0 +1,37 @@
+#pragma once
+#include <cstdint>
+#include "PresentMode.hpp"
+
+namespace giygas {
+
+    class RendererInitParameters {
+    public:
+        // How many frames the CPU may record while previous frames are still executing on the GPU. More frames in
+        // flight favours throughput, fewer favours latency. Must be between 1 and 4, and is independent of the number
+        // of swapchain images.
+        uint32_t frames_in_flight = 2;
+
+        // The requested present mode. Falls back to a similar mode, and finally to Fifo, when not supported.
+        PresentMode present_mode = PresentMode::Fifo;
+
+        // When enabled, submit() does not wait for the next frame's resources to become available. The wait instead
+        // happens in Renderer::wait_for_next_frame(), which should be called before game logic runs so input is
+        // sampled as late as possible, and must be called before any per frame data is written.
+        bool low_latency = false;
+
+        // How many threads record draws into command buffers, including the thread calling submit(). Passes with
+        // enough draws are split into contiguous chunks which are recorded in parallel and executed in their original
+        // order. Must be between 1 and 16; 1 records everything on the calling thread.
+        uint32_t recording_thread_count = 1;
+
+        // When enabled, draws within each pass are reordered to group draws sharing a pipeline, descriptor set and
+        // buffers, which reduces state changes. Passes marked as order dependent are left alone.
+        bool sort_draws = false;
+
+        // File the pipeline cache is loaded from at initialization and saved to at shutdown, so pipelines compiled in
+        // an earlier run are not compiled again. The file is ignored when it was written by another device or driver
+        // version. Null keeps the cache in memory only.
+        const char *pipeline_cache_path = nullptr;
+    };
+
+}
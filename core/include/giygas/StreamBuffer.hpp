@@ -0,0 +1,58 @@
+#pragma once
+#include <giygas/export.h>
+#include "VertexBuffer.hpp"
+#include "IndexBuffer.hpp"
+#include "UniformBuffer.hpp"
+#include "RendererType.hpp"
+#include <cstdint>
+
+namespace giygas {
+
+    // A region of a stream buffer, valid until the end of the frame it was allocated for.
+    class StreamAllocation {
+    public:
+        // Where the caller writes the region's contents.
+        uint8_t *data = nullptr;
+
+        // Byte offset of the region within the stream buffer. Use this as the DrawInfo vertex buffer or index buffer
+        // offset, or as the dynamic offset of a uniform buffer slot bound to uniform_buffer(), when drawing from the
+        // region.
+        uint32_t offset = 0;
+    };
+
+    // Transient data which is written every frame, such as UI, debug lines, particles or per object uniforms. Each
+    // frame in flight gets its own region of one persistently mapped buffer, which is handed out by bumping a pointer
+    // and is reset once the GPU is done with the frame that last used it. Writing through a stream buffer never records
+    // a copy, and allocating never waits on the GPU.
+    //
+    // Allocations may only be made from the thread which submits frames, and belong to the next submitted frame. In
+    // low latency mode, Renderer::wait_for_next_frame() must be called after submitting a frame before allocating
+    // again, which is where the wait for the frame's region happens.
+    class GIYGAS_EXPORT StreamBuffer {
+    public:
+        virtual ~StreamBuffer() = default;
+        virtual RendererType renderer_type() const = 0;
+
+        // Reserves size bytes of this frame's part of the buffer, at an offset aligned to alignment, which must be a
+        // power of two; use the vertex stride or index size when drawing from the region. Returns false when the
+        // frame's part is full.
+        virtual bool allocate(uint32_t size, uint32_t alignment, StreamAllocation &allocation) = 0;
+
+        // Bytes available to each frame.
+        virtual uint32_t capacity() const = 0;
+
+        // Alignment to allocate regions with when they are read through uniform_buffer().
+        virtual uint32_t uniform_alignment() const = 0;
+
+        // Views of the whole buffer to draw from. These are owned by the stream buffer and can not be written; contents
+        // are only written through allocate().
+        virtual const VertexBuffer *vertex_buffer() const = 0;
+        virtual const GenericIndexBuffer *index_buffer_16() const = 0;
+        virtual const GenericIndexBuffer *index_buffer_32() const = 0;
+
+        // Only usable with dynamic uniform buffer slots. Regions read through it must be at least as large as the
+        // range of the slot's binding.
+        virtual const GenericUniformBuffer *uniform_buffer() const = 0;
+    };
+
+}
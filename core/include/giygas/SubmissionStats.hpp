@@ -0,0 +1,45 @@
+#pragma once
+#include <cstdint>
+
+namespace giygas {
+
+    // Counters gathered while recording a submission. Skipped binds are binds which were left out because the same
+    // state was already bound by a previous draw in the pass.
+    class SubmissionStats {
+    public:
+        uint32_t draw_count = 0;
+        uint32_t pipeline_binds = 0;
+        uint32_t pipeline_binds_skipped = 0;
+        uint32_t vertex_buffer_binds = 0;
+        uint32_t vertex_buffer_binds_skipped = 0;
+        uint32_t index_buffer_binds = 0;
+        uint32_t index_buffer_binds_skipped = 0;
+        uint32_t descriptor_set_binds = 0;
+        uint32_t descriptor_set_binds_skipped = 0;
+        uint32_t push_constant_updates = 0;
+        uint32_t push_constant_updates_skipped = 0;
+        uint32_t viewport_updates = 0;
+        uint32_t viewport_updates_skipped = 0;
+        uint32_t scissor_updates = 0;
+        uint32_t scissor_updates_skipped = 0;
+
+        void add(const SubmissionStats &other) {
+            draw_count += other.draw_count;
+            pipeline_binds += other.pipeline_binds;
+            pipeline_binds_skipped += other.pipeline_binds_skipped;
+            vertex_buffer_binds += other.vertex_buffer_binds;
+            vertex_buffer_binds_skipped += other.vertex_buffer_binds_skipped;
+            index_buffer_binds += other.index_buffer_binds;
+            index_buffer_binds_skipped += other.index_buffer_binds_skipped;
+            descriptor_set_binds += other.descriptor_set_binds;
+            descriptor_set_binds_skipped += other.descriptor_set_binds_skipped;
+            push_constant_updates += other.push_constant_updates;
+            push_constant_updates_skipped += other.push_constant_updates_skipped;
+            viewport_updates += other.viewport_updates;
+            viewport_updates_skipped += other.viewport_updates_skipped;
+            scissor_updates += other.scissor_updates;
+            scissor_updates_skipped += other.scissor_updates_skipped;
+        }
+    };
+
+}
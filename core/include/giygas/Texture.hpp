@@ -33,6 +33,25 @@ namespace giygas {
             TextureUsageFlags flags
         ) = 0;
 
+        // Same as create(), but returns right away. Data conversion and staging happen on a background thread, after
+        // which the upload goes out with the next submitted frame. The texture must not be used in a descriptor set or
+        // framebuffer until is_ready() returns true; format(), width() and height() are valid immediately.
+        virtual void create_async(
+            std::unique_ptr<uint8_t[]> &&data,
+            uint32_t size,
+            uint32_t width,
+            uint32_t height,
+            TextureFormat input_format,
+            TextureFormat desired_format,
+            TextureUsageFlags flags
+        ) = 0;
+
+        // Whether the texture has been created and may be used. Textures created with create() are ready right away.
+        virtual bool is_ready() const = 0;
+
+        // Blocks until is_ready() returns true. This only waits on the background thread, never on the GPU.
+        virtual void wait_until_ready() const = 0;
+
         virtual TextureFormat format() const = 0;
         virtual const void *texture_impl() const = 0;
 
@@ -5,10 +5,20 @@
 
 namespace giygas {
 
-    class UniformBuffer {
+    // Anything a descriptor set can read uniforms from, whether or not it can be written directly.
+    class GenericUniformBuffer {
     public:
-        virtual ~UniformBuffer() = default;
+        virtual ~GenericUniformBuffer() = default;
         virtual RendererType renderer_type() const = 0;
+        virtual const void *cast_to_specific() const = 0;
+    };
+
+    class UniformBuffer : public GenericUniformBuffer {
+    public:
+        ~UniformBuffer() override = default;
+
+        // The data belongs to the next submitted frame. In low latency mode, Renderer::wait_for_next_frame() must be
+        // called after submitting a frame before writing again.
         virtual void set_data(uint32_t offset, const uint8_t *data, uint32_t size) = 0;
     };
 
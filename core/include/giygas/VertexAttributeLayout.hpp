@@ -2,6 +2,7 @@
 #include <cstddef>
 #include <vector>
 #include <giygas/export.h>
+#include "VertexInputRate.hpp"
 
 namespace giygas {
 
@@ -17,6 +18,9 @@ namespace giygas {
         size_t stride;
         size_t attribute_count;
         const VertexAttribute *attributes;
+
+        // Zero initialized layouts advance once per vertex.
+        VertexInputRate input_rate;
     };
 
 }
@@ -11,7 +11,11 @@ namespace giygas {
 
     enum VertexBufferCreateFlags {
         VertexBufferCreateFlag_None     = 0,
-        VertexBufferCreateFlag_Writable = 1 << 0
+        VertexBufferCreateFlag_Writable = 1 << 0,
+
+        // Writable buffers only. Don't keep a copy of the contents in system memory, at the cost of reading back
+        // from mapped memory when an update has to be carried over to a recycled buffer.
+        VertexBufferCreateFlag_NoShadowCopy = 1 << 1
     };
 
     class GIYGAS_EXPORT VertexBuffer {
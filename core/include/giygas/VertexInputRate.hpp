@@ -0,0 +1,14 @@
+#pragma once
+#include <giygas/export.h>
+
+namespace giygas {
+
+    enum class GIYGAS_EXPORT VertexInputRate {
+        // Attributes advance once per vertex. This is the zero value, so it is the default.
+        Vertex = 0,
+
+        // Attributes advance once per instance, for example a per sprite transform shared by all of its vertices.
+        Instance
+    };
+
+}
@@ -12,6 +12,12 @@ namespace giygas {
         virtual bool initialize_for_vulkan() = 0;
         virtual const char **get_required_instance_extensions(unsigned int *count) const = 0;
         virtual VkResult create_surface(VkInstance instance, VkSurfaceKHR *surface) = 0;
+
+        // Headless contexts have no surface. The renderer renders into a ring of offscreen_image_count() images of
+        // offscreen_extent() size in place of a swapchain.
+        virtual bool is_headless() const = 0;
+        virtual VkExtent2D offscreen_extent() const = 0;
+        virtual uint32_t offscreen_image_count() const = 0;
     };
 
 }
@@ -3,9 +3,12 @@
 #include <giygas/Framebuffer.hpp>
 #include <giygas/VertexBuffer.hpp>
 #include <giygas/IndexBuffer.hpp>
+#include <giygas/IndirectBuffer.hpp>
 #include "IndexRange.hpp"
 #include "UniformBuffer.hpp"
 #include "DescriptorSet.hpp"
+#include "Viewport.hpp"
+#include "ScissorRange.hpp"
 
 namespace giygas {
 
@@ -30,6 +33,11 @@ namespace giygas {
         const Framebuffer *framebuffer;
         uint32_t clear_value_count;
         const ClearValue *clear_values;
+
+        // Viewport and scissor for draws which do not set their own. Null covers the whole framebuffer, so pipelines
+        // do not depend on the size of what they render to.
+        const Viewport *viewport;
+        const ScissorRange *scissor;
     };
 
     class PushConstants {
@@ -48,6 +56,35 @@ namespace giygas {
         IndexRange index_range;
         PushConstants vertex_push_constants;
         PushConstants fragment_push_constants;
+
+        // The fields below are optional, and zero initializing them gives the behaviour of a plain draw.
+
+        // Byte offsets into each vertex buffer, or null to start every binding at the beginning of its buffer. Along
+        // with the index buffer offset and base vertex, this lets many meshes share the same buffers.
+        const uint32_t *vertex_buffer_offsets;
+        uint32_t index_buffer_offset;
+        int32_t base_vertex;
+
+        // Overrides the pass viewport and scissor for this draw, for example to render split screen views in one pass.
+        const Viewport *viewport;
+        const ScissorRange *scissor;
+
+        // Byte offsets for the descriptor set's dynamic uniform buffer slots, in order of binding index. Per object
+        // uniforms can be allocated from a stream buffer and drawn with nothing but a different offset.
+        uint32_t dynamic_offset_count;
+        const uint32_t *dynamic_offsets;
+
+        // Instanced draws read vertex buffers with a per instance input rate once per instance. An instance count of
+        // zero draws a single instance.
+        uint32_t instance_count;
+        uint32_t first_instance;
+
+        // When an indirect buffer is given, the draw arguments are read from indirect_draw_count consecutive commands
+        // starting at indirect_first_command, and index_range, instance_count and first_instance are ignored. A draw
+        // count of zero reads a single command.
+        const IndirectBuffer *indirect_buffer;
+        uint32_t indirect_first_command;
+        uint32_t indirect_draw_count;
     };
 
     class PassSubmissionInfo {
@@ -55,6 +92,10 @@ namespace giygas {
         PassExecutionInfo pass_info;
         uint32_t draw_count;
         const DrawInfo *draws;
+
+        // Draws in an order dependent pass, such as blended geometry sorted back to front, are recorded in the given
+        // order even when draw sorting is enabled. Off when zero initialized.
+        bool is_order_dependent;
     };
 
 }
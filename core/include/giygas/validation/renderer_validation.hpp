@@ -0,0 +1,10 @@
+#pragma once
+#include <giygas/export.h>
+#include <giygas/RendererInitParameters.hpp>
+
+namespace giygas {
+namespace validation {
+
+    GIYGAS_EXPORT bool validate_renderer_initialize(const RendererInitParameters &params);
+
+}}
@@ -6,9 +6,11 @@
 namespace giygas {
 namespace validation {
 
+    // Indirect draws may read at most max_indirect_draw_count commands each.
     GIYGAS_EXPORT bool validate_submission_passes(
             const PassSubmissionInfo *passes
             , uint32_t pass_count
-            , RendererType renderer_type);
+            , RendererType renderer_type
+            , uint32_t max_indirect_draw_count);
 
 }}
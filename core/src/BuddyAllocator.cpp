@@ -0,0 +1,99 @@
+#include <cassert>
+#include "BuddyAllocator.hpp"
+
+using namespace giygas;
+using namespace std;
+
+BuddyAllocator::BuddyAllocator(uint64_t capacity, uint64_t min_region_size) {
+    assert(capacity > 0 && (capacity & (capacity - 1)) == 0);
+    assert(min_region_size > 0 && min_region_size <= capacity);
+
+    _capacity = capacity;
+    _min_order = order_of(min_region_size);
+    _max_order = order_of(capacity);
+    _free_regions.resize(_max_order - _min_order + 1);
+    _free_regions.back().insert(0);
+}
+
+uint32_t BuddyAllocator::order_of(uint64_t size) {
+    // Smallest order whose region holds size bytes.
+    uint32_t order = 0;
+    while ((static_cast<uint64_t>(1) << order) < size) {
+        ++order;
+    }
+    return order;
+}
+
+uint64_t BuddyAllocator::region_size(uint64_t size, uint64_t alignment) const {
+    return region_size(size, alignment, static_cast<uint64_t>(1) << _min_order);
+}
+
+uint64_t BuddyAllocator::region_size(uint64_t size, uint64_t alignment, uint64_t min_region_size) {
+    uint64_t required = size > alignment ? size : alignment;
+    required = required > min_region_size ? required : min_region_size;
+    return static_cast<uint64_t>(1) << order_of(required);
+}
+
+bool BuddyAllocator::allocate(uint64_t size, uint64_t alignment, uint64_t &offset) {
+    uint64_t region = region_size(size, alignment);
+    if (region > _capacity) {
+        return false;
+    }
+    uint32_t order = order_of(region);
+
+    // Find the smallest free region that fits, then split it down to the requested order. The lower half is kept
+    // and the upper half goes back on the free list at each step.
+    uint32_t found_order = order;
+    while (found_order <= _max_order && _free_regions[found_order - _min_order].empty()) {
+        ++found_order;
+    }
+    if (found_order > _max_order) {
+        return false;
+    }
+
+    set<uint64_t> &found_regions = _free_regions[found_order - _min_order];
+    uint64_t found_offset = *found_regions.begin();
+    found_regions.erase(found_regions.begin());
+
+    while (found_order > order) {
+        --found_order;
+        _free_regions[found_order - _min_order].insert(found_offset + (static_cast<uint64_t>(1) << found_order));
+    }
+
+    _used += region;
+    offset = found_offset;
+    return true;
+}
+
+void BuddyAllocator::free(uint64_t offset, uint64_t size, uint64_t alignment) {
+    uint64_t region = region_size(size, alignment);
+    uint32_t order = order_of(region);
+    assert(offset % region == 0);
+    _used -= region;
+
+    while (order < _max_order) {
+        uint64_t buddy = offset ^ (static_cast<uint64_t>(1) << order);
+        set<uint64_t> &free_regions = _free_regions[order - _min_order];
+        auto it = free_regions.find(buddy);
+        if (it == free_regions.end()) {
+            break;
+        }
+        free_regions.erase(it);
+        offset = offset < buddy ? offset : buddy;
+        ++order;
+    }
+
+    _free_regions[order - _min_order].insert(offset);
+}
+
+uint64_t BuddyAllocator::capacity() const {
+    return _capacity;
+}
+
+uint64_t BuddyAllocator::used() const {
+    return _used;
+}
+
+bool BuddyAllocator::is_empty() const {
+    return _used == 0;
+}
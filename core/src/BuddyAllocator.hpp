@@ -0,0 +1,42 @@
+#pragma once
+#include <cstdint>
+#include <set>
+#include <vector>
+
+namespace giygas {
+
+    // Places power of two sized regions inside a range of capacity bytes, which must itself be a power of two. Every
+    // region is aligned to its own size, so any alignment up to the region size comes for free. Freed regions merge
+    // with their free buddy, which keeps fragmentation bounded without a separate compaction step.
+    class BuddyAllocator final {
+
+        uint64_t _capacity = 0;
+        uint32_t _min_order = 0;
+        uint32_t _max_order = 0;
+        uint64_t _used = 0;
+
+        // Offsets of the free regions of each order, lowest address first.
+        std::vector<std::set<uint64_t>> _free_regions;
+
+        static uint32_t order_of(uint64_t size);
+
+    public:
+        BuddyAllocator() = default;
+        BuddyAllocator(uint64_t capacity, uint64_t min_region_size);
+
+        // The size of the region allocate() reserves for the given size and alignment.
+        uint64_t region_size(uint64_t size, uint64_t alignment) const;
+        static uint64_t region_size(uint64_t size, uint64_t alignment, uint64_t min_region_size);
+
+        // Reserves region_size(size, alignment) bytes. Returns false when no region of that size is free.
+        bool allocate(uint64_t size, uint64_t alignment, uint64_t &offset);
+
+        // Releases a region returned by allocate(), with the same size and alignment it was allocated with.
+        void free(uint64_t offset, uint64_t size, uint64_t alignment);
+
+        uint64_t capacity() const;
+        uint64_t used() const;
+        bool is_empty() const;
+    };
+
+}
@@ -221,6 +221,19 @@ VkResult GLFWContext::create_surface(
 ) {
     return glfwCreateWindowSurface(instance, _window, nullptr, surface);
 }
+
+bool GLFWContext::is_headless() const {
+    return false;
+}
+
+VkExtent2D GLFWContext::offscreen_extent() const {
+    VkExtent2D extent = {_init_options.width, _init_options.height};
+    return extent;
+}
+
+uint32_t GLFWContext::offscreen_image_count() const {
+    return 0;
+}
 #endif //GIYGAS_WITH_VULKAN
 
 
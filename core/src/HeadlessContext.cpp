@@ -0,0 +1,97 @@
+#include <giygas/HeadlessContext.hpp>
+
+#ifdef GIYGAS_WITH_VULKAN
+
+using namespace giygas;
+using namespace std;
+
+HeadlessContext::HeadlessContext() {
+    _width = 640;
+    _height = 480;
+    _image_count = 3;
+    _is_valid = false;
+    _should_close = false;
+}
+
+bool HeadlessContext::initialize_for_vulkan() {
+    _is_valid = true;
+    return true;
+}
+
+const char** HeadlessContext::get_required_instance_extensions(
+    unsigned int *count
+) const {
+    // No surface, so no surface extensions.
+    *count = 0;
+    return nullptr;
+}
+
+VkResult HeadlessContext::create_surface(
+    VkInstance /*instance*/,
+    VkSurfaceKHR *surface
+) {
+    *surface = VK_NULL_HANDLE;
+    return VK_ERROR_EXTENSION_NOT_PRESENT;
+}
+
+bool HeadlessContext::is_headless() const {
+    return true;
+}
+
+VkExtent2D HeadlessContext::offscreen_extent() const {
+    VkExtent2D extent = {_width, _height};
+    return extent;
+}
+
+uint32_t HeadlessContext::offscreen_image_count() const {
+    return _image_count;
+}
+
+bool HeadlessContext::is_valid() const {
+    return _is_valid;
+}
+
+void* HeadlessContext::cast_to_specific(RendererType type) {
+    if (type == RendererType::Vulkan) {
+        return static_cast<VulkanContext *>(this);
+    }
+    return nullptr;
+}
+
+void HeadlessContext::update() {
+}
+
+bool HeadlessContext::should_close() const {
+    return _should_close;
+}
+
+uint32_t HeadlessContext::translate_key(InputKey key) const {
+    return static_cast<uint32_t>(key);
+}
+
+InputKey HeadlessContext::get_universal_key(uint32_t key) const {
+    return static_cast<InputKey>(key);
+}
+
+float HeadlessContext::get_input(uint32_t /*input*/) const {
+    return 0.0f;
+}
+
+EventHandler<uint32_t, float> HeadlessContext::input_changed() {
+    return _input_changed.make_handler();
+}
+
+void HeadlessContext::set_size(uint32_t width, uint32_t height) {
+    _width = width;
+    _height = height;
+}
+
+void HeadlessContext::set_image_count(uint32_t image_count) {
+    _image_count = image_count;
+}
+
+void HeadlessContext::request_close() {
+    _should_close = true;
+}
+
+#endif // GIYGAS_WITH_VULKAN
@@ -0,0 +1,108 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace giygas {
+
+    // A bump allocator for short lived scratch memory. Everything allocated from the arena is released at once by
+    // reset(). Allocations which do not fit go to overflow blocks, which are folded into a single larger block on the
+    // next reset, so an arena that sees the same usage every frame stops touching the heap after the first frame.
+    // Memory is not constructed or destructed, so it should only hold trivial types.
+    class LinearArena final {
+
+        std::unique_ptr<uint8_t[]> _block;
+        size_t _capacity = 0;
+        size_t _offset = 0;
+
+        std::vector<std::unique_ptr<uint8_t[]>> _overflow_blocks;
+        size_t _overflow_total = 0;
+        size_t _overflow_capacity = 0;
+        size_t _overflow_offset = 0;
+
+        static const size_t min_overflow_block_size = 4096;
+
+        static uint8_t *align_pointer(uint8_t *pointer, size_t alignment) {
+            uintptr_t address = reinterpret_cast<uintptr_t>(pointer);
+            uintptr_t aligned = (address + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1);
+            return pointer + (aligned - address);
+        }
+
+        void *allocate_overflow(size_t size, size_t alignment) {
+            if (!_overflow_blocks.empty()) {
+                uint8_t *base = _overflow_blocks.back().get();
+                uint8_t *result = align_pointer(base + _overflow_offset, alignment);
+                if (static_cast<size_t>(result - base) + size <= _overflow_capacity) {
+                    _overflow_offset = static_cast<size_t>(result - base) + size;
+                    return result;
+                }
+            }
+
+            size_t block_size = size + alignment;
+            if (block_size < min_overflow_block_size) {
+                block_size = min_overflow_block_size;
+            }
+            if (block_size < _capacity) {
+                block_size = _capacity;
+            }
+
+            _overflow_blocks.emplace_back(new uint8_t[block_size]);
+            _overflow_total += block_size;
+            _overflow_capacity = block_size;
+
+            uint8_t *base = _overflow_blocks.back().get();
+            uint8_t *result = align_pointer(base, alignment);
+            _overflow_offset = static_cast<size_t>(result - base) + size;
+            return result;
+        }
+
+    public:
+        explicit LinearArena(size_t initial_capacity = 0) {
+            if (initial_capacity > 0) {
+                _block = std::unique_ptr<uint8_t[]>(new uint8_t[initial_capacity]);
+                _capacity = initial_capacity;
+            }
+        }
+
+        LinearArena(const LinearArena &) = delete;
+        LinearArena &operator=(const LinearArena &) = delete;
+        LinearArena(LinearArena &&) noexcept = delete;
+        LinearArena &operator=(LinearArena &&) noexcept = delete;
+
+        // Returns memory for size bytes at the given power of two alignment, valid until the next reset().
+        void *allocate(size_t size, size_t alignment) {
+            if (_block != nullptr) {
+                uint8_t *result = align_pointer(_block.get() + _offset, alignment);
+                size_t end = static_cast<size_t>(result - _block.get()) + size;
+                if (end <= _capacity) {
+                    _offset = end;
+                    return result;
+                }
+            }
+            return allocate_overflow(size, alignment);
+        }
+
+        template<typename T>
+        T *allocate_array(size_t count) {
+            return static_cast<T *>(allocate(count * sizeof(T), alignof(T)));
+        }
+
+        void reset() {
+            if (!_overflow_blocks.empty()) {
+                _capacity += _overflow_total;
+                _block = std::unique_ptr<uint8_t[]>(new uint8_t[_capacity]);
+                _overflow_blocks.clear();
+                _overflow_total = 0;
+                _overflow_capacity = 0;
+                _overflow_offset = 0;
+            }
+            _offset = 0;
+        }
+
+        size_t capacity() const {
+            return _capacity;
+        }
+    };
+
+}
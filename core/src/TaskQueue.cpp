@@ -0,0 +1,41 @@
+#include "TaskQueue.hpp"
+
+using namespace giygas;
+using namespace std;
+
+TaskQueue::TaskQueue() {
+    _thread = thread(&TaskQueue::thread_main, this);
+}
+
+TaskQueue::~TaskQueue() {
+    {
+        lock_guard<mutex> lock(_mutex);
+        _is_stopping = true;
+    }
+    _task_available.notify_one();
+    _thread.join();
+}
+
+void TaskQueue::enqueue(Task task) {
+    {
+        lock_guard<mutex> lock(_mutex);
+        _tasks.push_back(move(task));
+    }
+    _task_available.notify_one();
+}
+
+void TaskQueue::thread_main() {
+    unique_lock<mutex> lock(_mutex);
+    for (;;) {
+        _task_available.wait(lock, [this] { return _is_stopping || !_tasks.empty(); });
+        if (_tasks.empty()) {
+            return;
+        }
+
+        Task task = move(_tasks.front());
+        _tasks.pop_front();
+        lock.unlock();
+        task();
+        lock.lock();
+    }
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace giygas {
+
+    // A single background thread running tasks in the order they were enqueued. Tasks still queued when the queue is
+    // destroyed are run before the thread exits.
+    class TaskQueue final {
+
+        using Task = std::function<void()>;
+
+        std::thread _thread;
+        std::mutex _mutex;
+        std::condition_variable _task_available;
+        std::deque<Task> _tasks;
+        bool _is_stopping = false;
+
+        void thread_main();
+
+    public:
+        TaskQueue();
+        TaskQueue(const TaskQueue &) = delete;
+        TaskQueue &operator=(const TaskQueue &) = delete;
+        TaskQueue(TaskQueue &&) noexcept = delete;
+        TaskQueue &operator=(TaskQueue &&) noexcept = delete;
+        ~TaskQueue();
+
+        void enqueue(Task task);
+    };
+
+}
@@ -0,0 +1,72 @@
+#include "WorkerPool.hpp"
+
+using namespace giygas;
+using namespace std;
+
+WorkerPool::WorkerPool(uint32_t thread_count) {
+    for (uint32_t i = 1; i < thread_count; ++i) {
+        _threads.emplace_back(&WorkerPool::worker_main, this, i);
+    }
+}
+
+WorkerPool::~WorkerPool() {
+    {
+        lock_guard<mutex> lock(_mutex);
+        _is_stopping = true;
+    }
+    _work_available.notify_all();
+
+    for (thread &worker : _threads) {
+        worker.join();
+    }
+}
+
+uint32_t WorkerPool::thread_count() const {
+    return static_cast<uint32_t>(_threads.size()) + 1;
+}
+
+void WorkerPool::parallel_for(uint32_t task_count, const Task &task) {
+    if (task_count == 0) {
+        return;
+    }
+
+    unique_lock<mutex> lock(_mutex);
+    _task = &task;
+    _task_count = task_count;
+    _next_task = 0;
+    _unfinished_task_count = task_count;
+    _work_available.notify_all();
+
+    run_tasks(lock, 0);
+    _work_finished.wait(lock, [this] { return _unfinished_task_count == 0; });
+
+    _task = nullptr;
+    _task_count = 0;
+    _next_task = 0;
+}
+
+void WorkerPool::worker_main(uint32_t worker_index) {
+    unique_lock<mutex> lock(_mutex);
+    for (;;) {
+        _work_available.wait(lock, [this] { return _is_stopping || _next_task < _task_count; });
+        if (_is_stopping) {
+            return;
+        }
+        run_tasks(lock, worker_index);
+    }
+}
+
+void WorkerPool::run_tasks(unique_lock<mutex> &lock, uint32_t worker_index) {
+    while (_next_task < _task_count) {
+        uint32_t task_index = _next_task++;
+        const Task &task = *_task;
+
+        lock.unlock();
+        task(task_index, worker_index);
+        lock.lock();
+
+        if (--_unfinished_task_count == 0) {
+            _work_finished.notify_all();
+        }
+    }
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace giygas {
+
+    // A fixed set of threads that run batches of indexed tasks. The thread calling parallel_for() takes part in the
+    // work as worker 0, so a pool with a thread count of 1 owns no threads at all.
+    class WorkerPool final {
+
+        using Task = std::function<void(uint32_t task_index, uint32_t worker_index)>;
+
+        std::vector<std::thread> _threads;
+        std::mutex _mutex;
+        std::condition_variable _work_available;
+        std::condition_variable _work_finished;
+        const Task *_task = nullptr;
+        uint32_t _task_count = 0;
+        uint32_t _next_task = 0;
+        uint32_t _unfinished_task_count = 0;
+        bool _is_stopping = false;
+
+        void worker_main(uint32_t worker_index);
+        void run_tasks(std::unique_lock<std::mutex> &lock, uint32_t worker_index);
+
+    public:
+        explicit WorkerPool(uint32_t thread_count);
+        WorkerPool(const WorkerPool &) = delete;
+        WorkerPool &operator=(const WorkerPool &) = delete;
+        WorkerPool(WorkerPool &&) noexcept = delete;
+        WorkerPool &operator=(WorkerPool &&) noexcept = delete;
+        ~WorkerPool();
+
+        uint32_t thread_count() const;
+
+        // Runs task(i, worker) for every i in [0, task_count) and returns once all of them have finished. A worker
+        // index is only ever used by one thread at a time, so it can select per thread resources.
+        void parallel_for(uint32_t task_count, const Task &task);
+    };
+
+}
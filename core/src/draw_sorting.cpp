@@ -0,0 +1,101 @@
+#include "draw_sorting.hpp"
+#include "LinearArena.hpp"
+#include "hash.hpp"
+
+using namespace giygas;
+using namespace std;
+
+static uint64_t hash_pointer(const void *pointer) {
+    return mix_bits(static_cast<uint64_t>(reinterpret_cast<uintptr_t>(pointer)));
+}
+
+uint64_t giygas::make_draw_sort_key(const DrawInfo &draw) {
+    uint64_t vertex_buffers_hash = 0;
+    for (uint32_t i = 0; i < draw.vertex_buffer_count; ++i) {
+        vertex_buffers_hash = mix_bits(vertex_buffers_hash ^ hash_pointer(draw.vertex_buffers[i]));
+    }
+
+    // 20 bits of pipeline, 16 of descriptor set, 16 of vertex buffers and 12 of index buffer, most significant first.
+    return (hash_pointer(draw.pipeline) >> 44) << 44
+        | (hash_pointer(draw.descriptor_set) >> 48) << 28
+        | (vertex_buffers_hash >> 48) << 12
+        | hash_pointer(draw.index_buffer) >> 52;
+}
+
+DrawSortEntry *giygas::radix_sort_draws(DrawSortEntry *entries, DrawSortEntry *scratch, size_t count) {
+    const size_t digit_count = sizeof(uint64_t);
+    size_t histograms[digit_count][256] = {};
+
+    for (size_t i = 0; i < count; ++i) {
+        uint64_t key = entries[i].key;
+        for (size_t digit = 0; digit < digit_count; ++digit) {
+            ++histograms[digit][(key >> (digit * 8)) & 0xff];
+        }
+    }
+
+    DrawSortEntry *source = entries;
+    DrawSortEntry *destination = scratch;
+
+    for (size_t digit = 0; digit < digit_count; ++digit) {
+        size_t *histogram = histograms[digit];
+        size_t shift = digit * 8;
+
+        // All entries share this byte, so this pass would not reorder anything.
+        if (count == 0 || histogram[(source[0].key >> shift) & 0xff] == count) {
+            continue;
+        }
+
+        size_t offset = 0;
+        for (size_t bucket = 0; bucket < 256; ++bucket) {
+            size_t bucket_count = histogram[bucket];
+            histogram[bucket] = offset;
+            offset += bucket_count;
+        }
+
+        for (size_t i = 0; i < count; ++i) {
+            const DrawSortEntry &entry = source[i];
+            destination[histogram[(entry.key >> shift) & 0xff]++] = entry;
+        }
+
+        DrawSortEntry *swap = source;
+        source = destination;
+        destination = swap;
+    }
+
+    return source;
+}
+
+const PassSubmissionInfo *giygas::sort_pass_draws(
+    const PassSubmissionInfo *passes,
+    uint32_t pass_count,
+    LinearArena &arena
+) {
+    auto *sorted_passes = arena.allocate_array<PassSubmissionInfo>(pass_count);
+
+    for (uint32_t pass_index = 0; pass_index < pass_count; ++pass_index) {
+        const PassSubmissionInfo &pass = passes[pass_index];
+        sorted_passes[pass_index] = pass;
+
+        if (pass.is_order_dependent || pass.draw_count < 2) {
+            continue;
+        }
+
+        size_t draw_count = pass.draw_count;
+        auto *entries = arena.allocate_array<DrawSortEntry>(draw_count);
+        auto *scratch = arena.allocate_array<DrawSortEntry>(draw_count);
+        for (size_t i = 0; i < draw_count; ++i) {
+            entries[i].key = make_draw_sort_key(pass.draws[i]);
+            entries[i].draw_index = static_cast<uint32_t>(i);
+        }
+
+        const DrawSortEntry *sorted = radix_sort_draws(entries, scratch, draw_count);
+
+        auto *draws = arena.allocate_array<DrawInfo>(draw_count);
+        for (size_t i = 0; i < draw_count; ++i) {
+            draws[i] = pass.draws[sorted[i].draw_index];
+        }
+        sorted_passes[pass_index].draws = draws;
+    }
+
+    return sorted_passes;
+}
@@ -0,0 +1,28 @@
+#pragma once
+#include <giygas/submission.hpp>
+#include <cstddef>
+#include <cstdint>
+
+namespace giygas {
+
+    class LinearArena;
+
+    class DrawSortEntry {
+    public:
+        uint64_t key;
+        uint32_t draw_index;
+    };
+
+    // Builds a key which groups draws by pipeline first, then descriptor set, vertex buffers and index buffer. Objects
+    // are hashed into the key, so a collision only costs a redundant bind.
+    uint64_t make_draw_sort_key(const DrawInfo &draw);
+
+    // Stable LSD radix sort by key, skipping key bytes which are the same for every entry. Sorts back and forth between
+    // entries and scratch, and returns whichever of the two holds the result.
+    DrawSortEntry *radix_sort_draws(DrawSortEntry *entries, DrawSortEntry *scratch, size_t count);
+
+    // Returns a copy of the passes in which the draws of every pass not marked as order dependent are sorted by key.
+    // The copy and the sorted draws are allocated from the arena.
+    const PassSubmissionInfo *sort_pass_draws(const PassSubmissionInfo *passes, uint32_t pass_count, LinearArena &arena);
+
+}
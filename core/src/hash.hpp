@@ -0,0 +1,17 @@
+#pragma once
+#include <cstdint>
+
+namespace giygas {
+
+    // The MurmurHash3 finalizer. Spreads every input bit over the whole result, for hashing keys made of ids, enums
+    // and pointers whose low bits barely change.
+    inline uint64_t mix_bits(uint64_t x) {
+        x ^= x >> 33;
+        x *= 0xff51afd7ed558ccdULL;
+        x ^= x >> 33;
+        x *= 0xc4ceb9fe1a85ec53ULL;
+        x ^= x >> 33;
+        return x;
+    }
+
+}
@@ -0,0 +1,18 @@
+#include <giygas/validation/renderer_validation.hpp>
+#include "validation_common.hpp"
+
+using namespace giygas;
+
+bool validation::validate_renderer_initialize(const RendererInitParameters &params) {
+    validate_begin("RendererInitialize");
+    validate(
+        params.frames_in_flight >= 1 && params.frames_in_flight <= 4,
+        "Frames in flight (params.frames_in_flight) must be between 1 and 4, got " << params.frames_in_flight << "."
+    );
+    validate(
+        params.recording_thread_count >= 1 && params.recording_thread_count <= 16,
+        "Recording thread count (params.recording_thread_count) must be between 1 and 16, got "
+            << params.recording_thread_count << "."
+    );
+    return true;
+}
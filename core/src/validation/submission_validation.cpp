@@ -3,7 +3,12 @@
 
 using namespace giygas;
 
-bool validate_draw_info(const DrawInfo &info, uint32_t index, RendererType renderer_type) {
+bool validate_draw_info(
+    const DrawInfo &info,
+    uint32_t index,
+    RendererType renderer_type,
+    uint32_t max_indirect_draw_count
+) {
     validate_begin("CommandBufferDrawInfo");
     validate(info.pipeline != nullptr, "DrawInfo[" << index << "]: Given pipeline cannot be null");
 
@@ -47,6 +52,32 @@ bool validate_draw_info(const DrawInfo &info, uint32_t index, RendererType rende
         "RendererType of the CommandBuffer being recorded."
     );
 
+    if (info.indirect_buffer != nullptr) {
+        validate(
+            info.indirect_buffer->renderer_type() == renderer_type,
+            "DrawInfo[" << index << "]: RendererType of given IndirectBuffer does not match the "
+            "RendererType of the CommandBuffer being recorded."
+        );
+        validate(
+            info.indirect_buffer->is_valid(),
+            "DrawInfo[" << index << "]: IndirectBuffer is not in a valid state."
+        );
+
+        uint32_t draw_count = info.indirect_draw_count > 0 ? info.indirect_draw_count : 1;
+        validate(
+            draw_count <= max_indirect_draw_count,
+            "DrawInfo[" << index << "]: The given indirect draw count (" << draw_count << ") is greater than the "
+            "most commands the renderer can draw at once (" << max_indirect_draw_count << ")."
+        );
+        validate(
+            static_cast<uint64_t>(info.indirect_first_command) + draw_count
+                <= info.indirect_buffer->command_count(),
+            "DrawInfo[" << index << "]: The given indirect commands " << info.indirect_first_command << " to "
+            << static_cast<uint64_t>(info.indirect_first_command) + draw_count << " go past the end of the "
+            "IndirectBuffer, which holds " << info.indirect_buffer->command_count() << " commands."
+        );
+    }
+
     // Validate descriptor set
     if (info.pipeline->descriptor_set_count() > 0) {
         validate(
@@ -64,6 +95,19 @@ bool validate_draw_info(const DrawInfo &info, uint32_t index, RendererType rende
             "DrawInfo[" << index << "]: The given DescriptorSet is not compatible with the given "
             "Pipeline."
         );
+        validate(
+            info.dynamic_offset_count == info.descriptor_set->dynamic_offset_count(),
+            "DrawInfo[" << index << "]: The given dynamic offset count (" << info.dynamic_offset_count << ") "
+            "does not match the count of dynamic uniform buffer slots of the given DescriptorSet ("
+            << info.descriptor_set->dynamic_offset_count() << ")."
+        );
+    }
+    if (info.dynamic_offset_count > 0) {
+        validate(
+            info.dynamic_offsets != nullptr,
+            "DrawInfo[" << index << "]: Given pointer to dynamic offsets cannot be null if given "
+            "dynamic offset count is greater than zero."
+        );
     }
 
     // Validate push constants
@@ -92,10 +136,27 @@ bool validate_draw_info(const DrawInfo &info, uint32_t index, RendererType rende
         )
     }
 
+    if (info.viewport != nullptr) {
+        validate(
+            info.viewport->width > 0 && info.viewport->height > 0,
+            "DrawInfo[" << index << "]: The given viewport must have a width and height greater than zero."
+        )
+    }
+    if (info.scissor != nullptr) {
+        validate(
+            info.scissor->x >= 0 && info.scissor->y >= 0,
+            "DrawInfo[" << index << "]: The given scissor cannot have a negative offset."
+        )
+    }
+
     return true;
 }
 
-bool validate_pass_info(const PassSubmissionInfo &pass, RendererType renderer_type) {
+bool validate_pass_info(
+    const PassSubmissionInfo &pass,
+    RendererType renderer_type,
+    uint32_t max_indirect_draw_count
+) {
     validate_begin("CommandBuffersRecordPass");
 
     if (pass.draw_count > 0) {
@@ -168,6 +229,19 @@ bool validate_pass_info(const PassSubmissionInfo &pass, RendererType renderer_ty
         );
     }
 
+    if (pass.pass_info.viewport != nullptr) {
+        validate(
+            pass.pass_info.viewport->width > 0 && pass.pass_info.viewport->height > 0,
+            "Viewport specified by render pass info must have a width and height greater than zero."
+        )
+    }
+    if (pass.pass_info.scissor != nullptr) {
+        validate(
+            pass.pass_info.scissor->x >= 0 && pass.pass_info.scissor->y >= 0,
+            "Scissor specified by render pass info cannot have a negative offset."
+        )
+    }
+
     if (pass.draw_count > 0) {
         validate(
             pass.draws != nullptr,
@@ -176,7 +250,7 @@ bool validate_pass_info(const PassSubmissionInfo &pass, RendererType renderer_ty
         );
     }
     for (uint32_t i = 0; i < pass.draw_count; ++i) {
-        if (!validate_draw_info(pass.draws[i], i, renderer_type)) {
+        if (!validate_draw_info(pass.draws[i], i, renderer_type, max_indirect_draw_count)) {
             return false;
         }
     }
@@ -188,9 +262,10 @@ bool validation::validate_submission_passes(
     const PassSubmissionInfo *passes
     , uint32_t pass_count
     , RendererType renderer_type
+    , uint32_t max_indirect_draw_count
 ) {
     for (uint32_t i = 0; i < pass_count; ++i) {
-        if (!validate_pass_info(passes[i], renderer_type)) {
+        if (!validate_pass_info(passes[i], renderer_type, max_indirect_draw_count)) {
             return false;
         }
     }
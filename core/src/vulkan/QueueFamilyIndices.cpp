@@ -8,3 +8,7 @@ bool QueueFamilyIndices::is_complete() const {
         present_family != static_cast<unsigned int>(-1)
     );
 }
+
+bool QueueFamilyIndices::has_transfer_family() const {
+    return transfer_family != static_cast<unsigned int>(-1);
+}
@@ -7,6 +7,10 @@ namespace giygas {
         uint32_t graphics_family = static_cast<unsigned int>(-1);
         uint32_t present_family = static_cast<unsigned int>(-1);
 
+        // A family without graphics support to run uploads on, so they can overlap rendering. Optional.
+        uint32_t transfer_family = static_cast<unsigned int>(-1);
+
         bool is_complete() const;
+        bool has_transfer_family() const;
     };
 }
@@ -11,19 +11,18 @@ using namespace giygas;
 class BufferSafeDeletable final : public SwapchainSafeDeleteable {
 
     VkBuffer _handle;
-    VkDeviceMemory _device_memory;
+    VulkanAllocation _allocation;
 
 public:
 
-    BufferSafeDeletable(VkBuffer handle, VkDeviceMemory device_memory) {
+    BufferSafeDeletable(VkBuffer handle, const VulkanAllocation &allocation) {
         _handle = handle;
-        _device_memory = device_memory;
+        _allocation = allocation;
     }
 
     void delete_resources(VulkanRenderer &renderer) override {
-        VkDevice device = renderer.device();
-        vkDestroyBuffer(device, _handle, nullptr);
-        vkFreeMemory(device, _device_memory, nullptr);
+        vkDestroyBuffer(renderer.device(), _handle, nullptr);
+        renderer.free_memory(_allocation);
     }
 
 };
@@ -35,7 +34,7 @@ TEMPLATE CLASS::ReadOnlyBuffer(VulkanRenderer *renderer) {
 
 TEMPLATE CLASS::~ReadOnlyBuffer() {
     _renderer->delete_when_safe(unique_ptr<SwapchainSafeDeleteable>(
-        new BufferSafeDeletable(_handle, _device_memory)
+        new BufferSafeDeletable(_handle, _allocation)
     ));
 }
 
@@ -43,7 +42,6 @@ TEMPLATE
 void CLASS::set_data(uint32_t offset, const uint8_t *data, uint32_t size) {
     assert(_handle == VK_NULL_HANDLE && "Cannot set data more than once for a read-only buffer");
 
-    VkDevice device = _renderer->device();
     uint32_t total_size = offset + size;
 
     VkDeviceSize buffer_size = static_cast<VkDeviceSize>(total_size);
@@ -51,22 +49,35 @@ void CLASS::set_data(uint32_t offset, const uint8_t *data, uint32_t size) {
         buffer_size = 1;
     }
 
-    _renderer->create_buffer(
+    // The data never changes, so it goes to device local memory through a staging copy. Only when device local
+    // memory is host visible anyway is it written directly. That memory may be scarcer, for example a small heap
+    // which is over budget, in which case the staging copy is used after all.
+    if (_renderer->is_unified_memory() && _renderer->create_buffer(
         buffer_size
         , USAGE_FLAGS  /* usage */
-        , VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT  /* memory_properties */
+        , VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT
+            | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT  /* required_memory_properties */
+        , 0  /* preferred_memory_properties */
+        , _handle
+        , _allocation
+    )) {
+        if (size > 0 && _allocation.mapped != nullptr) {
+            std::copy_n(data, size, _allocation.mapped + offset);
+        }
+        return;
+    }
+
+    _renderer->create_buffer(
+        buffer_size
+        , USAGE_FLAGS | VK_BUFFER_USAGE_TRANSFER_DST_BIT  /* usage */
+        , VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT  /* required_memory_properties */
+        , 0  /* preferred_memory_properties */
         , _handle
-        , _device_memory
+        , _allocation
     );
 
-    // Vulkan does not support memory mappings of 0 bytes.
     if (size > 0) {
-        void *mapped_buffer;
-        if (vkMapMemory(device, _device_memory, offset, size, 0, &mapped_buffer) != VK_SUCCESS) {
-            return;
-        }
-        std::copy_n(data, size, static_cast<uint8_t *>(mapped_buffer));
-        vkUnmapMemory(device, _device_memory);
+        _renderer->upload_context().copy_to_buffer(data, size, _handle, offset);
     }
 }
 
@@ -83,4 +94,5 @@ VkBuffer CLASS::handle() const {
 namespace giygas {
     template class ReadOnlyBuffer<VK_BUFFER_USAGE_VERTEX_BUFFER_BIT>;
     template class ReadOnlyBuffer<VK_BUFFER_USAGE_INDEX_BUFFER_BIT>;
+    template class ReadOnlyBuffer<VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT>;
 }
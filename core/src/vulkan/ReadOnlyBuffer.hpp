@@ -2,6 +2,7 @@
 #include "VulkanVertexBuffer.hpp"
 #include <vulkan/vulkan.h>
 #include <memory>
+#include "VulkanMemoryAllocator.hpp"
 
 namespace giygas {
 
@@ -12,7 +13,7 @@ namespace giygas {
 
         VulkanRenderer *_renderer = nullptr;
         VkBuffer _handle = VK_NULL_HANDLE;
-        VkDeviceMemory _device_memory = VK_NULL_HANDLE;
+        VulkanAllocation _allocation;
 
     public:
         explicit ReadOnlyBuffer(VulkanRenderer *renderer);
@@ -32,5 +33,6 @@ namespace giygas {
 
     typedef ReadOnlyBuffer<VK_BUFFER_USAGE_VERTEX_BUFFER_BIT> ReadOnlyVertexBuffer;
     typedef ReadOnlyBuffer<VK_BUFFER_USAGE_INDEX_BUFFER_BIT>  ReadOnlyIndexBuffer;
+    typedef ReadOnlyBuffer<VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT> ReadOnlyIndirectBuffer;
 
 }
@@ -4,15 +4,40 @@
 #include "VulkanRenderer.hpp"
 #include "VulkanPipeline.hpp"
 #include "VulkanIndexBuffer.hpp"
+#include "VulkanIndirectBuffer.hpp"
 #include "VulkanVertexBuffer.hpp"
 #include "VulkanDescriptorSet.hpp"
 #include "VulkanRenderPass.hpp"
+#include "VulkanDrawState.hpp"
+#include "../WorkerPool.hpp"
+#include "../LinearArena.hpp"
 #include <giygas/validation/submission_validation.hpp>
 #include <algorithm>
 
 using namespace giygas;
 using namespace giygas::validation;
 
+// Passes with fewer draws than this per chunk are recorded inline, as the cost of the secondary command buffers would
+// outweigh the gain.
+static const uint32_t min_draws_per_chunk = 256;
+
+static VkViewport translate_viewport(const Viewport &viewport) {
+    VkViewport api_viewport = {};
+    api_viewport.x = viewport.x;
+    api_viewport.y = viewport.y;
+    api_viewport.width = viewport.width;
+    api_viewport.height = viewport.height;
+    api_viewport.minDepth = viewport.min_depth;
+    api_viewport.maxDepth = viewport.max_depth;
+    return api_viewport;
+}
+
+static VkRect2D translate_scissor(const ScissorRange &scissor) {
+    VkRect2D api_scissor = {};
+    api_scissor.offset = { scissor.x, scissor.y };
+    api_scissor.extent = { scissor.width, scissor.height };
+    return api_scissor;
+}
 
 class CommandBufferSafeDeletable final : public SwapchainSafeDeleteable {
 
@@ -51,6 +76,17 @@ void VulkanCommandBuffer::create(VulkanRenderer *renderer, VulkanCommandPool *po
     _handle = make_buffer(pool->handle());
 }
 
+void VulkanCommandBuffer::set_recording_workers(WorkerPool *workers, VulkanCommandPool *worker_pools) {
+    _workers = workers;
+    _worker_pools = worker_pools;
+    _chunk_handles.resize(workers != nullptr ? workers->thread_count() : 0);
+    _chunk_stats.resize(_chunk_handles.size());
+}
+
+void VulkanCommandBuffer::set_scratch_arenas(LinearArena *arenas) {
+    _arenas = arenas;
+}
+
 VkCommandBuffer VulkanCommandBuffer::make_buffer(VkCommandPool pool) {
     VkCommandBuffer handle;
     VkCommandBufferAllocateInfo alloc_info = {};
@@ -82,6 +118,7 @@ void VulkanCommandBuffer::record(const PassSubmissionInfo *passes, uint32_t pass
     begin_info.pInheritanceInfo = nullptr;
 
     vkBeginCommandBuffer(_handle, &begin_info);
+    _stats = SubmissionStats();
 
     for (uint32_t i = 0; i < pass_count; ++i) {
         record_pass(passes[i], swapchain_image_index);
@@ -106,8 +143,7 @@ void VulkanCommandBuffer::record_pass(const PassSubmissionInfo &info, uint32_t s
 
     size_t attachment_count = framebuffer_impl->attachment_count();
 
-    // TODO: Reduce frequency of allocation.
-    unique_ptr<VkClearValue[]> clear_values(new VkClearValue[attachment_count]);
+    VkClearValue *clear_values = _arenas[0].allocate_array<VkClearValue>(attachment_count);
 
     for (size_t i = 0; i < attachment_count; ++i) {
         const ClearValue &clear_value = info.pass_info.clear_values[i];
@@ -133,90 +169,185 @@ void VulkanCommandBuffer::record_pass(const PassSubmissionInfo &info, uint32_t s
     pass_begin_info.renderArea.extent.width = framebuffer_impl->width();
     pass_begin_info.renderArea.extent.height = framebuffer_impl->height();
     pass_begin_info.clearValueCount = static_cast<uint32_t>(attachment_count);
-    pass_begin_info.pClearValues = clear_values.get();
+    pass_begin_info.pClearValues = clear_values;
 
-    vkCmdBeginRenderPass(_handle, &pass_begin_info, VK_SUBPASS_CONTENTS_INLINE);
+    VkViewport pass_viewport = {};
+    if (info.pass_info.viewport != nullptr) {
+        pass_viewport = translate_viewport(*info.pass_info.viewport);
+    }
+    else {
+        pass_viewport.width = static_cast<float>(pass_begin_info.renderArea.extent.width);
+        pass_viewport.height = static_cast<float>(pass_begin_info.renderArea.extent.height);
+        pass_viewport.minDepth = 0;
+        pass_viewport.maxDepth = 1;
+    }
+    VkRect2D pass_scissor = pass_begin_info.renderArea;
+    if (info.pass_info.scissor != nullptr) {
+        pass_scissor = translate_scissor(*info.pass_info.scissor);
+    }
 
-    for (size_t i = 0; i < info.draw_count; ++i) {
-        record_draw(info.draws[i], _handle);
+    uint32_t chunk_count = 1;
+    if (_workers != nullptr) {
+        chunk_count = min(_workers->thread_count(), info.draw_count / min_draws_per_chunk);
+    }
+
+    if (chunk_count > 1) {
+        vkCmdBeginRenderPass(_handle, &pass_begin_info, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+        record_pass_chunks(
+            info,
+            pass_begin_info.renderPass,
+            pass_begin_info.framebuffer,
+            pass_viewport,
+            pass_scissor,
+            chunk_count
+        );
+        vkCmdExecuteCommands(_handle, chunk_count, _chunk_handles.data());
+    }
+    else {
+        vkCmdBeginRenderPass(_handle, &pass_begin_info, VK_SUBPASS_CONTENTS_INLINE);
+        VulkanDrawState state(_handle, &_stats, pass_viewport, pass_scissor);
+        for (size_t i = 0; i < info.draw_count; ++i) {
+            record_draw(info.draws[i], state, _arenas[0]);
+        }
     }
 
     vkCmdEndRenderPass(_handle);
 }
 
-void VulkanCommandBuffer::record_draw(const DrawInfo &info, VkCommandBuffer handle) {
+void VulkanCommandBuffer::record_pass_chunks(
+    const PassSubmissionInfo &info,
+    VkRenderPass pass,
+    VkFramebuffer framebuffer,
+    const VkViewport &pass_viewport,
+    const VkRect2D &pass_scissor,
+    uint32_t chunk_count
+) {
+    VkCommandBufferInheritanceInfo inheritance_info = {};
+    inheritance_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+    inheritance_info.renderPass = pass;
+    inheritance_info.subpass = 0;
+    inheritance_info.framebuffer = framebuffer;
+
+    VkCommandBufferBeginInfo begin_info = {};
+    begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    begin_info.flags = VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT | VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    begin_info.pInheritanceInfo = &inheritance_info;
+
+    // Each chunk is a contiguous range of draws, and chunks are executed in order, so draw order is preserved no
+    // matter which worker records which chunk. The task only captures a single pointer, which keeps std::function
+    // from allocating. Dynamic state is not inherited by secondary command buffers, so each chunk sets its own.
+    struct ChunkRecording {
+        VulkanCommandBuffer *buffer;
+        const PassSubmissionInfo *info;
+        const VkCommandBufferBeginInfo *begin_info;
+        const VkViewport *pass_viewport;
+        const VkRect2D *pass_scissor;
+        uint32_t chunk_count;
+    };
+    ChunkRecording recording = { this, &info, &begin_info, &pass_viewport, &pass_scissor, chunk_count };
+
+    _workers->parallel_for(chunk_count, [&recording](uint32_t chunk_index, uint32_t worker_index) {
+        VulkanCommandBuffer &self = *recording.buffer;
+        const PassSubmissionInfo &pass = *recording.info;
+
+        VkCommandBuffer handle = self._worker_pools[worker_index].next_secondary_buffer();
+        SubmissionStats &stats = self._chunk_stats[chunk_index];
+        stats = SubmissionStats();
+        VulkanDrawState state(handle, &stats, *recording.pass_viewport, *recording.pass_scissor);
+        size_t first_draw = static_cast<size_t>(pass.draw_count) * chunk_index / recording.chunk_count;
+        size_t end_draw = static_cast<size_t>(pass.draw_count) * (chunk_index + 1) / recording.chunk_count;
+
+        vkBeginCommandBuffer(handle, recording.begin_info);
+        for (size_t i = first_draw; i < end_draw; ++i) {
+            self.record_draw(pass.draws[i], state, self._arenas[worker_index]);
+        }
+        vkEndCommandBuffer(handle);
+
+        self._chunk_handles[chunk_index] = handle;
+    });
+
+    for (uint32_t i = 0; i < chunk_count; ++i) {
+        _stats.add(_chunk_stats[i]);
+    }
+}
+
+void VulkanCommandBuffer::record_draw(const DrawInfo &info, VulkanDrawState &state, LinearArena &arena) {
     const auto *pipeline = reinterpret_cast<const VulkanPipeline *>(info.pipeline);
     const auto *index_buffer
         = reinterpret_cast<const VulkanGenericIndexBuffer *>(info.index_buffer->cast_to_specific());
-    const auto *descriptor_set = reinterpret_cast<const VulkanDescriptorSet *>(info.descriptor_set);
+    const auto *descriptor_set = static_cast<const VulkanDescriptorSet *>(info.descriptor_set);
 
+    state.bind_pipeline(pipeline->handle(), pipeline->layout_handle());
 
-    vkCmdBindPipeline(handle, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline->handle());
-
-    // TODO: Reduce frequency of allocation.
-    unique_ptr<VkBuffer[]> buffers(new VkBuffer[info.vertex_buffer_count]);
-    unique_ptr<VkDeviceSize[]> offsets(new VkDeviceSize[info.vertex_buffer_count]);
+    VkBuffer *buffers = arena.allocate_array<VkBuffer>(info.vertex_buffer_count);
+    VkDeviceSize *offsets = arena.allocate_array<VkDeviceSize>(info.vertex_buffer_count);
     for (size_t i = 0; i < info.vertex_buffer_count; ++i) {
         const auto *vertex_buffer
             = reinterpret_cast<const VulkanVertexBuffer *>(info.vertex_buffers[i]);
         buffers[i] = vertex_buffer->handle();
-        offsets[i] = 0;
+        offsets[i] = info.vertex_buffer_offsets != nullptr ? info.vertex_buffer_offsets[i] : 0;
     }
 
-    vkCmdBindVertexBuffers(
-        handle,
-        0, // first buffer
-        static_cast<uint32_t>(info.vertex_buffer_count),
-        buffers.get(),
-        offsets.get()
-    );
-
-    vkCmdBindIndexBuffer(handle, index_buffer->handle(), 0, index_buffer->index_type());
+    state.bind_vertex_buffers(info.vertex_buffer_count, buffers, offsets);
+    state.bind_index_buffer(index_buffer->handle(), info.index_buffer_offset, index_buffer->index_type());
 
     if (info.vertex_push_constants.range.size > 0) {
-        vkCmdPushConstants(
-            handle,
-            pipeline->layout_handle(),
-            VK_SHADER_STAGE_VERTEX_BIT,
+        state.push_vertex_constants(
             static_cast<uint32_t>(info.vertex_push_constants.range.offset * sizeof(uint8_t)),
             static_cast<uint32_t>(info.vertex_push_constants.range.size * sizeof(uint8_t)),
             info.vertex_push_constants.data
         );
     }
     if (info.fragment_push_constants.range.size > 0) {
-        vkCmdPushConstants(
-            handle,
-            pipeline->layout_handle(),
-            VK_SHADER_STAGE_FRAGMENT_BIT,
+        state.push_fragment_constants(
             static_cast<uint32_t>(info.fragment_push_constants.range.offset * sizeof(uint8_t)),
             static_cast<uint32_t>(info.fragment_push_constants.range.size * sizeof(uint8_t)),
             info.fragment_push_constants.data
         );
     }
 
+    state.set_viewport(info.viewport != nullptr ? translate_viewport(*info.viewport) : state.pass_viewport());
+    state.set_scissor(info.scissor != nullptr ? translate_scissor(*info.scissor) : state.pass_scissor());
+
     if (info.descriptor_set != nullptr) {
-        VkDescriptorSet descriptor_set_handle = descriptor_set->handle();
-        vkCmdBindDescriptorSets(
-            handle,
-            VK_PIPELINE_BIND_POINT_GRAPHICS,
-            pipeline->layout_handle(),
-            0,
-            1,
-            &descriptor_set_handle,
-            0,
-            nullptr
+        state.bind_descriptor_set(
+            descriptor_set->handle(_renderer->current_frame_index()),
+            info.dynamic_offset_count,
+            info.dynamic_offsets
         );
     }
 
-    vkCmdDrawIndexed(
-        handle,
-        info.index_range.count,
-        1,  // instance count
-        info.index_range.offset,
-        0,  // vertex offset
-        0   // first instance
-    );
+    if (info.indirect_buffer != nullptr) {
+        record_indirect_draw(info, state.handle());
+    }
+    else {
+        vkCmdDrawIndexed(
+            state.handle(),
+            info.index_range.count,
+            info.instance_count > 0 ? info.instance_count : 1,
+            info.index_range.offset,
+            info.base_vertex,
+            info.first_instance
+        );
+    }
+    ++state.stats().draw_count;
+}
+
+void VulkanCommandBuffer::record_indirect_draw(const DrawInfo &info, VkCommandBuffer handle) {
+    const auto *indirect_buffer = reinterpret_cast<const VulkanIndirectBuffer *>(info.indirect_buffer);
+    const auto stride = static_cast<uint32_t>(sizeof(VkDrawIndexedIndirectCommand));
+    VkDeviceSize offset = static_cast<VkDeviceSize>(info.indirect_first_command) * stride;
+    uint32_t draw_count = info.indirect_draw_count > 0 ? info.indirect_draw_count : 1;
 
+    if (draw_count == 1 || _renderer->enabled_features().multiDrawIndirect) {
+        vkCmdDrawIndexedIndirect(handle, indirect_buffer->handle(), offset, draw_count, stride);
+        return;
+    }
+
+    // Without multiDrawIndirect, each command needs its own draw.
+    for (uint32_t i = 0; i < draw_count; ++i) {
+        vkCmdDrawIndexedIndirect(handle, indirect_buffer->handle(), offset + i * stride, 1, stride);
+    }
 }
 
 bool VulkanCommandBuffer::is_valid() const {
@@ -226,3 +357,7 @@ bool VulkanCommandBuffer::is_valid() const {
 VkCommandBuffer VulkanCommandBuffer::handle() const {
     return _handle;
 }
+
+const SubmissionStats &VulkanCommandBuffer::stats() const {
+    return _stats;
+}
@@ -1,11 +1,16 @@
 #pragma once
 #include <giygas/submission.hpp>
+#include <giygas/SubmissionStats.hpp>
 #include <vulkan/vulkan.h>
+#include <vector>
 
 namespace giygas {
 
     class VulkanRenderer;
     class VulkanCommandPool;
+    class WorkerPool;
+    class VulkanDrawState;
+    class LinearArena;
 
     class VulkanCommandBuffer final {
 
@@ -13,10 +18,30 @@ namespace giygas {
         VulkanCommandPool *_pool = nullptr;
         VkCommandBuffer _handle = VK_NULL_HANDLE;
 
+        // Optional parallel recording, using one command pool per worker of the worker pool.
+        WorkerPool *_workers = nullptr;
+        VulkanCommandPool *_worker_pools = nullptr;
+        std::vector<VkCommandBuffer> _chunk_handles;
+        std::vector<SubmissionStats> _chunk_stats;
+        SubmissionStats _stats;
+
+        // Scratch memory for recording, one arena per recording thread. Reset by the renderer once the frame using
+        // this command buffer is no longer in flight.
+        LinearArena *_arenas = nullptr;
+
         VkCommandBuffer make_buffer(VkCommandPool pool);
         void free_buffers();
         void record_pass(const PassSubmissionInfo &info, uint32_t swapchain_image_index);
-        void record_draw(const DrawInfo &info, VkCommandBuffer handle);
+        void record_pass_chunks(
+            const PassSubmissionInfo &info,
+            VkRenderPass pass,
+            VkFramebuffer framebuffer,
+            const VkViewport &pass_viewport,
+            const VkRect2D &pass_scissor,
+            uint32_t chunk_count
+        );
+        void record_draw(const DrawInfo &info, VulkanDrawState &state, LinearArena &arena);
+        void record_indirect_draw(const DrawInfo &info, VkCommandBuffer handle);
 
     public:
         VulkanCommandBuffer() = default;
@@ -27,10 +52,13 @@ namespace giygas {
         //
         //RendererType renderer_type() const override;
         void create(VulkanRenderer *renderer, VulkanCommandPool *pool);
+        void set_recording_workers(WorkerPool *workers, VulkanCommandPool *worker_pools);
+        void set_scratch_arenas(LinearArena *arenas);
         void record(const PassSubmissionInfo *passes, uint32_t pass_count, uint32_t swapchain_image_index);
         void destroy();
         bool is_valid() const;
         VkCommandBuffer handle() const;
+        const SubmissionStats &stats() const;
     };
 
 
@@ -16,7 +16,13 @@ VulkanCommandPool::~VulkanCommandPool() {
 //}
 
 void VulkanCommandPool::create(VulkanRenderer* renderer) {
+    create(renderer, renderer->queue_family_indices().graphics_family, VK_COMMAND_POOL_CREATE_TRANSIENT_BIT);
+}
+
+void VulkanCommandPool::create(VulkanRenderer *renderer, uint32_t queue_family_index, VkCommandPoolCreateFlags flags) {
     _renderer = renderer;
+    _queue_family_index = queue_family_index;
+    _flags = flags;
     _handle = make_pool();
 }
 
@@ -28,11 +34,33 @@ void VulkanCommandPool::destroy() {
     assert(_renderer != nullptr);
     vkDestroyCommandPool(_renderer->device(), _handle, nullptr);
     _handle = VK_NULL_HANDLE;
+    _secondary_buffers.clear();
+    _secondary_buffers_in_use = 0;
 }
 
 void VulkanCommandPool::reset_buffers() {
     assert(_renderer != nullptr);
     vkResetCommandPool(_renderer->device(), _handle, 0);
+    _secondary_buffers_in_use = 0;
+}
+
+VkCommandBuffer VulkanCommandPool::next_secondary_buffer() {
+    assert(_renderer != nullptr);
+
+    // Secondary buffers stay allocated across resets of the pool, and are handed out again after the next reset.
+    if (_secondary_buffers_in_use == _secondary_buffers.size()) {
+        VkCommandBuffer handle = VK_NULL_HANDLE;
+        VkCommandBufferAllocateInfo alloc_info = {};
+        alloc_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        alloc_info.commandPool = _handle;
+        alloc_info.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+        alloc_info.commandBufferCount = 1;
+
+        vkAllocateCommandBuffers(_renderer->device(), &alloc_info, &handle);
+        _secondary_buffers.push_back(handle);
+    }
+
+    return _secondary_buffers[_secondary_buffers_in_use++];
 }
 
 bool VulkanCommandPool::is_valid() const {
@@ -47,8 +75,8 @@ VkCommandPool VulkanCommandPool::make_pool() const {
     VkCommandPool handle;
     VkCommandPoolCreateInfo create_info = {};
     create_info.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
-    create_info.queueFamilyIndex = _renderer->queue_family_indices().graphics_family;
-    create_info.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+    create_info.queueFamilyIndex = _queue_family_index;
+    create_info.flags = _flags;
 
     vkCreateCommandPool(_renderer->device(), &create_info, nullptr, &handle);
     return handle;
@@ -1,6 +1,7 @@
 #pragma once
 #include <vulkan/vulkan.h>
 #include <memory>
+#include <vector>
 
 namespace giygas {
 
@@ -11,6 +12,10 @@ namespace giygas {
 
         VulkanRenderer *_renderer = nullptr;
         VkCommandPool _handle = VK_NULL_HANDLE;
+        uint32_t _queue_family_index = 0;
+        VkCommandPoolCreateFlags _flags = 0;
+        std::vector<VkCommandBuffer> _secondary_buffers;
+        size_t _secondary_buffers_in_use = 0;
 
         VkCommandPool make_pool() const;
 
@@ -23,7 +28,9 @@ namespace giygas {
         //
         //RendererType renderer_type() const override;
         void create(VulkanRenderer *renderer);
+        void create(VulkanRenderer *renderer, uint32_t queue_family_index, VkCommandPoolCreateFlags flags);
         void reset_buffers();
+        VkCommandBuffer next_secondary_buffer();
         bool is_valid() const;
         void destroy();
         VkCommandPool handle() const;
@@ -35,17 +35,22 @@ RendererType VulkanDescriptorPool::renderer_type() const {
 }
 
 void VulkanDescriptorPool::create(const DescriptorPoolParameters &params) {
-    array<VkDescriptorPoolSize, 2> sizes = {};
+    // Every descriptor set has a copy per frame in flight.
+    uint32_t frame_count = _renderer->frames_in_flight();
+
+    array<VkDescriptorPoolSize, 3> sizes = {};
     sizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-    sizes[0].descriptorCount = max<uint32_t>(params.uniform_buffer_descriptors, 1);
+    sizes[0].descriptorCount = max<uint32_t>(params.uniform_buffer_descriptors, 1) * frame_count;
     sizes[1].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-    sizes[1].descriptorCount = max<uint32_t>(params.sampler_descriptors, 1);
+    sizes[1].descriptorCount = max<uint32_t>(params.sampler_descriptors, 1) * frame_count;
+    sizes[2].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+    sizes[2].descriptorCount = max<uint32_t>(params.dynamic_uniform_buffer_descriptors, 1) * frame_count;
 
     VkDescriptorPoolCreateInfo create_info = {};
     create_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
     create_info.poolSizeCount = sizes.size();
     create_info.pPoolSizes = sizes.data();
-    create_info.maxSets = params.max_sets;
+    create_info.maxSets = params.max_sets * frame_count;
 
     vkCreateDescriptorPool(_renderer->device(), &create_info, nullptr, &_handle);
 }
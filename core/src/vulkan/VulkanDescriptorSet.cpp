@@ -1,3 +1,4 @@
+#include <algorithm>
 #include "VulkanDescriptorSet.hpp"
 #include "VulkanRenderer.hpp"
 #include "VulkanSampler.hpp"
@@ -7,31 +8,8 @@
 using namespace giygas;
 
 
-class DescriptorSetSafeDeletable final : public SwapchainSafeDeleteable {
-
-    VkDescriptorSetLayout _layout;
-
-public:
-
-    DescriptorSetSafeDeletable(VkDescriptorSetLayout layout) {
-        _layout = layout;
-    }
-
-    void delete_resources(VulkanRenderer &renderer) override {
-        // Don't need to and shouldn't free descriptor set since we haven't told the pool we want to
-        // be able to do that. Instead the pool will take care of freeing the descriptor sets.
-        //vkFreeDescriptorSets(device, _pool, 1, &_handle);
-
-        vkDestroyDescriptorSetLayout(renderer.device(), _layout, nullptr);
-    }
-
-};
-
-
 VulkanDescriptorSet::VulkanDescriptorSet(VulkanRenderer *renderer) {
     _renderer = renderer;
-    _layout = VK_NULL_HANDLE;
-    _handle = VK_NULL_HANDLE;
     _pool = VK_NULL_HANDLE;
     _uniform_buffer_count = 0;
     _sampler_count = 0;
@@ -39,8 +17,7 @@ VulkanDescriptorSet::VulkanDescriptorSet(VulkanRenderer *renderer) {
 }
 
 VulkanDescriptorSet::~VulkanDescriptorSet() {
-    _renderer->delete_when_safe(unique_ptr<SwapchainSafeDeleteable>(new DescriptorSetSafeDeletable(_layout)));
-    _layout = VK_NULL_HANDLE;
+    _renderer->cancel_frame_updates(this);
 }
 
 RendererType VulkanDescriptorSet::renderer_type() const {
@@ -48,7 +25,7 @@ RendererType VulkanDescriptorSet::renderer_type() const {
 }
 
 bool VulkanDescriptorSet::is_created() const {
-    return _handle != VK_NULL_HANDLE;
+    return _handles != nullptr;
 }
 
 bool VulkanDescriptorSet::has_descriptors() const {
@@ -67,11 +44,13 @@ void VulkanDescriptorSet::create(
     const VulkanDescriptorPool *pool,
     const DescriptorSetCreateParameters &params
 ) {
+    // The descriptor sets of a previous create() would be leaked, and its dynamic slots counted again.
+    assert(!is_created() && "A descriptor set can only be created once");
+    _dynamic_binding_indices.clear();
+
     _pool = pool->handle();
     assert(_pool != VK_NULL_HANDLE);
 
-    VkDevice device = _renderer->device();
-
 //    assert(params.immutable_sampler_count == 0 || params.immutable_sampler_count == params.sampler_count);
 //    unique_ptr<VkSampler[]> immutable_sampler_handles(new VkSampler[params.immutable_sampler_count]);
 //    for (size_t i = 0; i < params.immutable_sampler_count; ++i) {
@@ -87,14 +66,20 @@ void VulkanDescriptorSet::create(
         new VkDescriptorSetLayoutBinding[binding_count] {}
     );
     unique_ptr<VkSampler[]> sampler_handles(new VkSampler[params.sampler_count] {});
+    unique_ptr<uint64_t[]> immutable_sampler_ids(new uint64_t[binding_count] {});
 
     for (uint32_t i = 0; i < params.uniform_buffer_count; ++i) {
         VkDescriptorSetLayoutBinding &binding = bindings[binding_index++];
         const UniformBufferDescriptorSlot &slot = params.uniform_buffer_slots[i];
         binding.binding = slot.binding_index;
         binding.descriptorCount = 1;
-        binding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        binding.descriptorType = slot.is_dynamic
+            ? VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC
+            : VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
         binding.stageFlags = translate_shader_stages(slot.stages);
+        if (slot.is_dynamic) {
+            _dynamic_binding_indices.push_back(slot.binding_index);
+        }
     }
     for (uint32_t i = 0; i < params.sampler_count; ++i) {
         VkDescriptorSetLayoutBinding &binding = bindings[binding_index++];
@@ -107,24 +92,31 @@ void VulkanDescriptorSet::create(
             const auto *sampler_impl = reinterpret_cast<const VulkanSampler *>(slot.immutable_sampler);
             sampler_handles[i] = sampler_impl->handle();
             binding.pImmutableSamplers = &sampler_handles[i];
+            immutable_sampler_ids[binding_index - 1] = sampler_impl->id();
         }
         binding.stageFlags = translate_shader_stages(slot.stages);
     }
 
-    VkDescriptorSetLayoutCreateInfo layout_info = {};
-    layout_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
-    layout_info.bindingCount = binding_count;
-    layout_info.pBindings = bindings.get();
+    // Sets with the same slots share a layout.
+    _layout = _renderer->layouts().get_descriptor_set_layout(
+        bindings.get(),
+        immutable_sampler_ids.get(),
+        binding_count
+    );
 
-    vkCreateDescriptorSetLayout(device, &layout_info, nullptr, &_layout);
+    uint32_t frame_count = _renderer->frames_in_flight();
+    unique_ptr<VkDescriptorSetLayout[]> layouts(new VkDescriptorSetLayout[frame_count]);
+    fill_n(layouts.get(), frame_count, _layout->handle);
+    _handles = unique_ptr<VkDescriptorSet[]>(new VkDescriptorSet[frame_count] {});
+    _stale_frames = unique_ptr<bool[]>(new bool[frame_count] {});
 
     VkDescriptorSetAllocateInfo alloc_info = {};
     alloc_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
     alloc_info.descriptorPool = _pool;
-    alloc_info.descriptorSetCount = 1;
-    alloc_info.pSetLayouts = &_layout;
+    alloc_info.descriptorSetCount = frame_count;
+    alloc_info.pSetLayouts = layouts.get();
 
-    vkAllocateDescriptorSets(device, &alloc_info, &_handle);
+    vkAllocateDescriptorSets(_renderer->device(), &alloc_info, _handles.get());
 
     _uniform_buffer_count = params.uniform_buffer_count;
     _sampler_count = params.sampler_count;
@@ -136,19 +128,72 @@ void VulkanDescriptorSet::update(const DescriptorSetUpdateParameters &params) {
     // TODO: Need beter validation than this.
     assert(params.uniform_buffer_count == _uniform_buffer_count);
     assert(params.sampler_count == _sampler_count);
-    
+
+    _uniform_buffer_bindings.assign(
+        params.uniform_buffer_bindings,
+        params.uniform_buffer_bindings + params.uniform_buffer_count
+    );
+    _sampler_bindings.assign(params.sampler_bindings, params.sampler_bindings + params.sampler_count);
+
+    // Uniform buffers which are recreated or resized need their descriptors rewritten.
+    _uniform_buffer_handlers.clear();
+    for (const UniformBufferDescriptorBinding &binding : _uniform_buffer_bindings) {
+        assert(binding.buffer != nullptr);
+        assert(binding.buffer->renderer_type() == RendererType::Vulkan);
+        const auto *buffer_impl = static_cast<const VulkanGenericUniformBuffer *>(binding.buffer->cast_to_specific());
+        if (is_dynamic_binding(binding.binding_index)) {
+            // The whole buffer would be out of bounds for any non-zero dynamic offset.
+            assert(binding.range > 0 && "Dynamic uniform buffer bindings need a range");
+            assert(binding.range <= _renderer->limits().maxUniformBufferRange);
+        }
+        UniformBufferEventHandler handler = buffer_impl->layout_changed();
+        handler.delegate = [this](const VulkanGenericUniformBuffer *) { invalidate_frames(); };
+        _uniform_buffer_handlers.emplace_back(move(handler));
+    }
+
+    invalidate_frames();
+    _has_descriptors = true;
+}
+
+void VulkanDescriptorSet::invalidate_frames() {
+    // The set of the frame being recorded is not in use by any submitted frame, so it is written right away.
+    assert(_renderer->is_frame_ready() && "wait_for_next_frame() must be called before writing the next frame");
+    uint32_t frame_index = _renderer->current_frame_index();
+    for (uint32_t i = 0, ilen = _renderer->frames_in_flight(); i < ilen; ++i) {
+        _stale_frames[i] = i != frame_index;
+    }
+    write_frame(frame_index);
+    if (_renderer->frames_in_flight() > 1) {
+        _renderer->update_when_frames_available(this);
+    }
+}
+
+bool VulkanDescriptorSet::update_frame(uint32_t frame_index) {
+    if (_stale_frames[frame_index]) {
+        write_frame(frame_index);
+        _stale_frames[frame_index] = false;
+    }
+    for (uint32_t i = 0, ilen = _renderer->frames_in_flight(); i < ilen; ++i) {
+        if (_stale_frames[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void VulkanDescriptorSet::write_frame(uint32_t frame_index) {
     VkDevice device = _renderer->device();
 
     unique_ptr<VkDescriptorBufferInfo[]> buffer_infos(
-        new VkDescriptorBufferInfo[params.uniform_buffer_count] {}
+        new VkDescriptorBufferInfo[_uniform_buffer_count] {}
     );
     unique_ptr<VkDescriptorImageInfo[]> image_infos(
-        new VkDescriptorImageInfo[params.sampler_count] {}
+        new VkDescriptorImageInfo[_sampler_count] {}
     );
 
-//    for (size_t i = 0; i < params.uniform_buffer_count; ++i) {
+//    for (size_t i = 0; i < _uniform_buffer_count; ++i) {
 //        VkDescriptorBufferInfo &buffer_info = buffer_infos[i];
-//        const UniformBufferDescriptorBinding &binding = params.uniform_buffer_bindings[i];
+//        const UniformBufferDescriptorBinding &binding = _uniform_buffer_bindings[i];
 //        assert(binding.buffer != nullptr);
 //        assert(binding.buffer->renderer_type() == RendererType::Vulkan);
 //        const auto *buffer_impl = reinterpret_cast<const VulkanUniformBuffer *>(binding.buffer);
@@ -157,9 +202,9 @@ void VulkanDescriptorSet::update(const DescriptorSetUpdateParameters &params) {
 //        buffer_info.range = buffer_impl->size();
 //    }
 
-//    for (size_t i = 0; i < params.sampler_count; ++i) {
+//    for (size_t i = 0; i < _sampler_count; ++i) {
 //        VkDescriptorImageInfo &image_info = image_infos[i];
-//        const SamplerDescriptorBinding &binding = params.sampler_bindings[i];
+//        const SamplerDescriptorBinding &binding = _sampler_bindings[i];
 //        const Texture *texture = binding.texture;
 //        assert(texture != nullptr);
 //        assert(texture->renderer_type() == RendererType::Vulkan);
@@ -173,38 +218,42 @@ void VulkanDescriptorSet::update(const DescriptorSetUpdateParameters &params) {
 //        image_info.imageView = texture_impl->image_view();
 //    }
 
-    uint32_t write_count = params.uniform_buffer_count + params.sampler_count;
+    uint32_t write_count = _uniform_buffer_count + _sampler_count;
     unique_ptr<VkWriteDescriptorSet[]> writes (new VkWriteDescriptorSet[write_count] {});
     uint32_t write_index = 0;
 
-    for (uint32_t i = 0; i < params.uniform_buffer_count; ++i) {
-        const UniformBufferDescriptorBinding &binding = params.uniform_buffer_bindings[i];
+    for (uint32_t i = 0; i < _uniform_buffer_count; ++i) {
+        const UniformBufferDescriptorBinding &binding = _uniform_buffer_bindings[i];
 
         VkDescriptorBufferInfo &buffer_info = buffer_infos[i];
         assert(binding.buffer != nullptr);
         assert(binding.buffer->renderer_type() == RendererType::Vulkan);
-        const auto *buffer_impl = reinterpret_cast<const VulkanUniformBuffer *>(binding.buffer);
+        const auto *buffer_impl = static_cast<const VulkanGenericUniformBuffer *>(binding.buffer->cast_to_specific());
+        bool is_dynamic = is_dynamic_binding(binding.binding_index);
         buffer_info.buffer = buffer_impl->handle();
-        buffer_info.offset = 0;
-        buffer_info.range = buffer_impl->size();
+        buffer_info.offset = buffer_impl->frame_offset(frame_index);
+        buffer_info.range = is_dynamic ? binding.range : buffer_impl->size();
 
         VkWriteDescriptorSet &write = writes[write_index++];
         write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-        write.dstSet = _handle;
+        write.dstSet = _handles[frame_index];
         write.dstBinding = binding.binding_index;
         write.dstArrayElement = 0;
-        write.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        write.descriptorType = is_dynamic
+            ? VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC
+            : VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
         write.descriptorCount = 1;
         write.pBufferInfo = &buffer_info;
     }
-    for (size_t i = 0; i < params.sampler_count; ++i) {
-        const SamplerDescriptorBinding &binding = params.sampler_bindings[i];
+    for (size_t i = 0; i < _sampler_count; ++i) {
+        const SamplerDescriptorBinding &binding = _sampler_bindings[i];
 
         VkDescriptorImageInfo &image_info = image_infos[i];
         const Texture *texture = binding.texture;
         assert(texture != nullptr);
         assert(texture->renderer_type() == RendererType::Vulkan);
         const auto *texture_impl = static_cast<const VulkanTexture *>(texture->texture_impl());
+        assert(texture_impl->is_ready() && "Texture created with create_async() is not ready yet");
         assert(texture_impl->image_view(0) != VK_NULL_HANDLE);
         const Sampler *sampler = binding.sampler;
         assert(sampler->renderer_type() == RendererType::Vulkan);
@@ -215,7 +264,7 @@ void VulkanDescriptorSet::update(const DescriptorSetUpdateParameters &params) {
 
         VkWriteDescriptorSet &write = writes[write_index++];
         write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-        write.dstSet = _handle;
+        write.dstSet = _handles[frame_index];
         write.dstBinding = binding.binding_index;
         write.dstArrayElement = 0;
         write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
@@ -230,16 +279,23 @@ void VulkanDescriptorSet::update(const DescriptorSetUpdateParameters &params) {
         0,  //descriptor copy count
         nullptr  // pdescriptorcopies
     );
+}
 
-    _has_descriptors = true;
+uint32_t VulkanDescriptorSet::dynamic_offset_count() const {
+    return static_cast<uint32_t>(_dynamic_binding_indices.size());
+}
+
+bool VulkanDescriptorSet::is_dynamic_binding(uint32_t binding_index) const {
+    return find(_dynamic_binding_indices.begin(), _dynamic_binding_indices.end(), binding_index)
+        != _dynamic_binding_indices.end();
 }
 
-VkDescriptorSetLayout VulkanDescriptorSet::layout() const {
+const shared_ptr<const VulkanDescriptorSetLayout> &VulkanDescriptorSet::layout() const {
     return _layout;
 }
 
-VkDescriptorSet VulkanDescriptorSet::handle() const {
-    return _handle;
+VkDescriptorSet VulkanDescriptorSet::handle(uint32_t frame_index) const {
+    return _handles[frame_index];
 }
 
 VkShaderStageFlags VulkanDescriptorSet::translate_shader_stages(ShaderStage stages) const {
@@ -1,23 +1,40 @@
 #pragma once
 #include <giygas/DescriptorSet.hpp>
 #include <vulkan/vulkan.h>
+#include <memory>
+#include <vector>
 #include "VulkanDescriptorPool.hpp"
+#include "VulkanFrameResource.hpp"
+#include "VulkanUniformBuffer.hpp"
+#include "VulkanLayoutCache.hpp"
 
 namespace giygas {
 
     class VulkanRenderer;
 
-    class VulkanDescriptorSet final : public DescriptorSet {
+    // One descriptor set per frame in flight, each referring to that frame's slice of its uniform buffers. Updates
+    // are written to the set of the frame being recorded right away, and to the other sets as their frames become
+    // available.
+    class VulkanDescriptorSet final : public DescriptorSet, public VulkanFrameResource {
 
         VulkanRenderer *_renderer;
-        VkDescriptorSetLayout _layout;
-        VkDescriptorSet _handle;
+        shared_ptr<const VulkanDescriptorSetLayout> _layout;
+        unique_ptr<VkDescriptorSet[]> _handles;
+        unique_ptr<bool[]> _stale_frames;
         VkDescriptorPool _pool;
         uint32_t _uniform_buffer_count;
         uint32_t _sampler_count;
         bool _has_descriptors;
 
+        vector<UniformBufferDescriptorBinding> _uniform_buffer_bindings;
+        vector<SamplerDescriptorBinding> _sampler_bindings;
+        vector<UniformBufferEventHandler> _uniform_buffer_handlers;
+        vector<uint32_t> _dynamic_binding_indices;
+
         VkShaderStageFlags translate_shader_stages(ShaderStage stages) const;
+        void write_frame(uint32_t frame_index);
+        void invalidate_frames();
+        bool is_dynamic_binding(uint32_t binding_index) const;
 
     public:
         VulkanDescriptorSet(VulkanRenderer *renderer);
@@ -32,14 +49,21 @@ namespace giygas {
         bool has_descriptors() const override;
         void create(const DescriptorSetCreateParameters &params) override;
         void update(const DescriptorSetUpdateParameters &params) override;
+        uint32_t dynamic_offset_count() const override;
+
+        //
+        // VulkanFrameResource implementation
+        //
+
+        bool update_frame(uint32_t frame_index) override;
 
         //
         // VulkanDescriptorSet implementation
         //
 
         void create(const VulkanDescriptorPool *pool, const DescriptorSetCreateParameters &params);
-        VkDescriptorSetLayout layout() const;
-        VkDescriptorSet handle() const;
+        const shared_ptr<const VulkanDescriptorSetLayout> &layout() const;
+        VkDescriptorSet handle(uint32_t frame_index) const;
 
 
     };
@@ -0,0 +1,182 @@
+#include "VulkanDrawState.hpp"
+#include <cstring>
+
+using namespace giygas;
+using namespace std;
+
+VulkanDrawState::VulkanDrawState(
+    VkCommandBuffer handle,
+    SubmissionStats *stats,
+    const VkViewport &pass_viewport,
+    const VkRect2D &pass_scissor
+) {
+    _handle = handle;
+    _stats = stats;
+    _pass_viewport = pass_viewport;
+    _pass_scissor = pass_scissor;
+}
+
+VkCommandBuffer VulkanDrawState::handle() const {
+    return _handle;
+}
+
+SubmissionStats &VulkanDrawState::stats() {
+    return *_stats;
+}
+
+const VkViewport &VulkanDrawState::pass_viewport() const {
+    return _pass_viewport;
+}
+
+const VkRect2D &VulkanDrawState::pass_scissor() const {
+    return _pass_scissor;
+}
+
+void VulkanDrawState::bind_pipeline(VkPipeline pipeline, VkPipelineLayout layout) {
+    if (pipeline == _pipeline) {
+        ++_stats->pipeline_binds_skipped;
+        return;
+    }
+
+    vkCmdBindPipeline(_handle, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+    ++_stats->pipeline_binds;
+    _pipeline = pipeline;
+
+    // Descriptor sets and push constants can not be assumed to survive a change of pipeline layout.
+    if (layout != _layout) {
+        _layout = layout;
+        _descriptor_set = VK_NULL_HANDLE;
+        _vertex_push_constants.size = 0;
+        _fragment_push_constants.size = 0;
+    }
+}
+
+void VulkanDrawState::bind_vertex_buffers(uint32_t count, const VkBuffer *buffers, const VkDeviceSize *offsets) {
+    if (count == _vertex_buffer_count
+        && memcmp(buffers, _vertex_buffers, count * sizeof(VkBuffer)) == 0
+        && memcmp(offsets, _vertex_buffer_offsets, count * sizeof(VkDeviceSize)) == 0
+    ) {
+        ++_stats->vertex_buffer_binds_skipped;
+        return;
+    }
+
+    vkCmdBindVertexBuffers(_handle, 0, count, buffers, offsets);
+    ++_stats->vertex_buffer_binds;
+
+    if (count <= max_tracked_vertex_buffers) {
+        _vertex_buffer_count = count;
+        memcpy(_vertex_buffers, buffers, count * sizeof(VkBuffer));
+        memcpy(_vertex_buffer_offsets, offsets, count * sizeof(VkDeviceSize));
+    }
+    else {
+        _vertex_buffer_count = 0;
+    }
+}
+
+void VulkanDrawState::bind_index_buffer(VkBuffer buffer, VkDeviceSize offset, VkIndexType index_type) {
+    if (buffer == _index_buffer && offset == _index_buffer_offset && index_type == _index_type) {
+        ++_stats->index_buffer_binds_skipped;
+        return;
+    }
+
+    vkCmdBindIndexBuffer(_handle, buffer, offset, index_type);
+    ++_stats->index_buffer_binds;
+    _index_buffer = buffer;
+    _index_buffer_offset = offset;
+    _index_type = index_type;
+}
+
+void VulkanDrawState::bind_descriptor_set(
+    VkDescriptorSet descriptor_set,
+    uint32_t dynamic_offset_count,
+    const uint32_t *dynamic_offsets
+) {
+    if (descriptor_set == _descriptor_set
+        && dynamic_offset_count == _dynamic_offset_count
+        && (dynamic_offset_count == 0
+            || memcmp(dynamic_offsets, _dynamic_offsets, dynamic_offset_count * sizeof(uint32_t)) == 0)
+    ) {
+        ++_stats->descriptor_set_binds_skipped;
+        return;
+    }
+
+    vkCmdBindDescriptorSets(
+        _handle,
+        VK_PIPELINE_BIND_POINT_GRAPHICS,
+        _layout,
+        0,
+        1,
+        &descriptor_set,
+        dynamic_offset_count,
+        dynamic_offsets
+    );
+    ++_stats->descriptor_set_binds;
+
+    if (dynamic_offset_count <= max_tracked_dynamic_offsets) {
+        _descriptor_set = descriptor_set;
+        _dynamic_offset_count = dynamic_offset_count;
+        if (dynamic_offset_count > 0) {
+            memcpy(_dynamic_offsets, dynamic_offsets, dynamic_offset_count * sizeof(uint32_t));
+        }
+    }
+    else {
+        _descriptor_set = VK_NULL_HANDLE;
+    }
+}
+
+void VulkanDrawState::push_vertex_constants(uint32_t offset, uint32_t size, const void *data) {
+    push_constants(_vertex_push_constants, VK_SHADER_STAGE_VERTEX_BIT, offset, size, data);
+}
+
+void VulkanDrawState::push_fragment_constants(uint32_t offset, uint32_t size, const void *data) {
+    push_constants(_fragment_push_constants, VK_SHADER_STAGE_FRAGMENT_BIT, offset, size, data);
+}
+
+void VulkanDrawState::push_constants(
+    PushConstantsState &state,
+    VkShaderStageFlags stage,
+    uint32_t offset,
+    uint32_t size,
+    const void *data
+) {
+    if (size == state.size && offset == state.offset && memcmp(data, state.data, size) == 0) {
+        ++_stats->push_constant_updates_skipped;
+        return;
+    }
+
+    vkCmdPushConstants(_handle, _layout, stage, offset, size, data);
+    ++_stats->push_constant_updates;
+
+    if (size <= max_tracked_push_constants_size) {
+        state.offset = offset;
+        state.size = size;
+        memcpy(state.data, data, size);
+    }
+    else {
+        state.size = 0;
+    }
+}
+
+void VulkanDrawState::set_viewport(const VkViewport &viewport) {
+    if (_has_viewport && memcmp(&viewport, &_viewport, sizeof(VkViewport)) == 0) {
+        ++_stats->viewport_updates_skipped;
+        return;
+    }
+
+    vkCmdSetViewport(_handle, 0, 1, &viewport);
+    ++_stats->viewport_updates;
+    _has_viewport = true;
+    _viewport = viewport;
+}
+
+void VulkanDrawState::set_scissor(const VkRect2D &scissor) {
+    if (_has_scissor && memcmp(&scissor, &_scissor, sizeof(VkRect2D)) == 0) {
+        ++_stats->scissor_updates_skipped;
+        return;
+    }
+
+    vkCmdSetScissor(_handle, 0, 1, &scissor);
+    ++_stats->scissor_updates;
+    _has_scissor = true;
+    _scissor = scissor;
+}
@@ -0,0 +1,85 @@
+#pragma once
+#include <giygas/SubmissionStats.hpp>
+#include <vulkan/vulkan.h>
+
+namespace giygas {
+
+    // Tracks the state bound in a command buffer while recording a pass, so binds which would not change anything
+    // can be skipped.
+    class VulkanDrawState final {
+
+        // The tracker gives up on skipping binds with more vertex buffers or push constant bytes than this, and simply
+        // binds them every time.
+        static const uint32_t max_tracked_vertex_buffers = 16;
+        static const uint32_t max_tracked_push_constants_size = 128;
+        static const uint32_t max_tracked_dynamic_offsets = 8;
+
+        class PushConstantsState {
+        public:
+            uint32_t offset = 0;
+            uint32_t size = 0;
+            uint8_t data[max_tracked_push_constants_size];
+        };
+
+        VkCommandBuffer _handle;
+        SubmissionStats *_stats;
+
+        VkPipeline _pipeline = VK_NULL_HANDLE;
+        VkPipelineLayout _layout = VK_NULL_HANDLE;
+        uint32_t _vertex_buffer_count = 0;
+        VkBuffer _vertex_buffers[max_tracked_vertex_buffers];
+        VkDeviceSize _vertex_buffer_offsets[max_tracked_vertex_buffers];
+        VkBuffer _index_buffer = VK_NULL_HANDLE;
+        VkDeviceSize _index_buffer_offset = 0;
+        VkIndexType _index_type = VK_INDEX_TYPE_UINT16;
+        VkDescriptorSet _descriptor_set = VK_NULL_HANDLE;
+        uint32_t _dynamic_offset_count = 0;
+        uint32_t _dynamic_offsets[max_tracked_dynamic_offsets];
+        PushConstantsState _vertex_push_constants;
+        PushConstantsState _fragment_push_constants;
+
+        // Viewport and scissor of the pass, used by draws which do not set their own. Both are dynamic state, which
+        // starts out undefined in every command buffer.
+        VkViewport _pass_viewport;
+        VkRect2D _pass_scissor;
+        bool _has_viewport = false;
+        VkViewport _viewport = {};
+        bool _has_scissor = false;
+        VkRect2D _scissor = {};
+
+        void push_constants(
+            PushConstantsState &state,
+            VkShaderStageFlags stage,
+            uint32_t offset,
+            uint32_t size,
+            const void *data
+        );
+
+    public:
+        VulkanDrawState(
+            VkCommandBuffer handle,
+            SubmissionStats *stats,
+            const VkViewport &pass_viewport,
+            const VkRect2D &pass_scissor
+        );
+        VulkanDrawState(const VulkanDrawState &) = delete;
+        VulkanDrawState &operator=(const VulkanDrawState &) = delete;
+        VulkanDrawState(VulkanDrawState &&) noexcept = delete;
+        VulkanDrawState &operator=(VulkanDrawState &&) noexcept = delete;
+
+        VkCommandBuffer handle() const;
+        SubmissionStats &stats();
+        const VkViewport &pass_viewport() const;
+        const VkRect2D &pass_scissor() const;
+
+        void bind_pipeline(VkPipeline pipeline, VkPipelineLayout layout);
+        void bind_vertex_buffers(uint32_t count, const VkBuffer *buffers, const VkDeviceSize *offsets);
+        void bind_index_buffer(VkBuffer buffer, VkDeviceSize offset, VkIndexType index_type);
+        void bind_descriptor_set(VkDescriptorSet descriptor_set, uint32_t dynamic_offset_count, const uint32_t *dynamic_offsets);
+        void push_vertex_constants(uint32_t offset, uint32_t size, const void *data);
+        void push_fragment_constants(uint32_t offset, uint32_t size, const void *data);
+        void set_viewport(const VkViewport &viewport);
+        void set_scissor(const VkRect2D &scissor);
+    };
+
+}
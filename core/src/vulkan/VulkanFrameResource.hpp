@@ -0,0 +1,18 @@
+#pragma once
+#include <cstdint>
+
+namespace giygas {
+
+    // A resource with one copy per frame in flight. A copy may only change while no submitted frame uses it, so
+    // changes made during a frame reach the other copies once the renderer moves on to their frames.
+    class VulkanFrameResource
+    {
+    public:
+        virtual ~VulkanFrameResource() = default;
+
+        // Brings the frame's copy up to date. Called once the frame's previous submission is complete. Returns true
+        // when every copy is up to date.
+        virtual bool update_frame(uint32_t frame_index) = 0;
+    };
+
+}
@@ -44,6 +44,11 @@ VkBuffer VulkanIndexBuffer<T, DeviceT, BufferT>::handle() const {
     return _buffer.handle();
 }
 
+template <typename T, typename DeviceT, typename BufferT>
+BufferT &VulkanIndexBuffer<T, DeviceT, BufferT>::buffer() {
+    return _buffer;
+}
+
 template <>
 VkIndexType VulkanIndexBuffer<uint32_t, uint32_t, ReadOnlyIndexBuffer>::index_type() const {
     return VK_INDEX_TYPE_UINT32;
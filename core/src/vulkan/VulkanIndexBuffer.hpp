@@ -54,6 +54,12 @@ namespace giygas {
         VkBuffer handle() const override;
         VkIndexType index_type() const override;
 
+        //
+        // VulkanIndexBuffer implementation
+        //
+
+        BufferT &buffer();
+
     };
 
 }
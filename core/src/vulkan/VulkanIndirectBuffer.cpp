@@ -0,0 +1,72 @@
+#include "VulkanIndirectBuffer.hpp"
+#include "VulkanRenderer.hpp"
+
+using namespace giygas;
+
+static_assert(
+    sizeof(IndexedIndirectCommand) == sizeof(VkDrawIndexedIndirectCommand),
+    "IndexedIndirectCommand must match the layout of VkDrawIndexedIndirectCommand"
+);
+
+void *VulkanIndirectBuffer::cast_to_renderer_specific() {
+    return this;
+}
+
+template <typename BufferT>
+VulkanIndirectBufferImpl<BufferT>::VulkanIndirectBufferImpl(VulkanRenderer *renderer, bool is_writable)
+    : _buffer(renderer)
+{
+    _is_writable = is_writable;
+    _command_count = 0;
+}
+
+template <typename BufferT>
+RendererType VulkanIndirectBufferImpl<BufferT>::renderer_type() const {
+    return RendererType::Vulkan;
+}
+
+template <typename BufferT>
+void VulkanIndirectBufferImpl<BufferT>::set_commands(
+    uint32_t first_command,
+    const IndexedIndirectCommand *commands,
+    uint32_t count
+) {
+    _buffer.set_data(
+        static_cast<uint32_t>(first_command * sizeof(IndexedIndirectCommand)),
+        reinterpret_cast<const uint8_t *>(commands),
+        static_cast<uint32_t>(count * sizeof(IndexedIndirectCommand))
+    );
+    if (first_command + count > _command_count) {
+        _command_count = first_command + count;
+    }
+}
+
+template <typename BufferT>
+bool VulkanIndirectBufferImpl<BufferT>::is_valid() const {
+    return _buffer.is_valid();
+}
+
+template <typename BufferT>
+bool VulkanIndirectBufferImpl<BufferT>::is_writable() const {
+    return _is_writable;
+}
+
+template <typename BufferT>
+uint32_t VulkanIndirectBufferImpl<BufferT>::command_count() const {
+    return _command_count;
+}
+
+template <typename BufferT>
+VkBuffer VulkanIndirectBufferImpl<BufferT>::handle() const {
+    return _buffer.handle();
+}
+
+template <typename BufferT>
+BufferT &VulkanIndirectBufferImpl<BufferT>::buffer() {
+    return _buffer;
+}
+
+namespace giygas {
+    template class VulkanIndirectBufferImpl<ReadOnlyIndirectBuffer>;
+    template class VulkanIndirectBufferImpl<WritableIndirectBuffer>;
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include <giygas/IndirectBuffer.hpp>
+#include <vulkan/vulkan.h>
+#include "ReadOnlyBuffer.hpp"
+#include "WritableBuffer.hpp"
+
+namespace giygas {
+
+    class VulkanRenderer;
+
+    class VulkanIndirectBuffer : public IndirectBuffer {
+    public:
+        ~VulkanIndirectBuffer() override = default;
+        void *cast_to_renderer_specific() override;
+
+        virtual VkBuffer handle() const = 0;
+    };
+
+
+    template <typename BufferT>
+    class VulkanIndirectBufferImpl final : public VulkanIndirectBuffer {
+
+        BufferT _buffer;
+        bool _is_writable;
+        uint32_t _command_count;
+
+    public:
+        VulkanIndirectBufferImpl(VulkanRenderer *renderer, bool is_writable);
+        VulkanIndirectBufferImpl(const VulkanIndirectBufferImpl &) = delete;
+        VulkanIndirectBufferImpl &operator=(const VulkanIndirectBufferImpl &) = delete;
+        VulkanIndirectBufferImpl(VulkanIndirectBufferImpl &&) noexcept = delete;
+        VulkanIndirectBufferImpl &operator=(VulkanIndirectBufferImpl &&) noexcept = delete;
+        ~VulkanIndirectBufferImpl() override = default;
+
+        //
+        // IndirectBuffer implementation
+        //
+
+        RendererType renderer_type() const override;
+        void set_commands(uint32_t first_command, const IndexedIndirectCommand *commands, uint32_t count) override;
+        bool is_valid() const override;
+        bool is_writable() const override;
+        uint32_t command_count() const override;
+
+        //
+        // VulkanIndirectBuffer implementation
+        //
+
+        VkBuffer handle() const override;
+
+        //
+        // VulkanIndirectBufferImpl implementation
+        //
+
+        BufferT &buffer();
+    };
+
+    extern template class VulkanIndirectBufferImpl<ReadOnlyIndirectBuffer>;
+    extern template class VulkanIndirectBufferImpl<WritableIndirectBuffer>;
+
+}
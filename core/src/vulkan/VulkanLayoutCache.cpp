@@ -0,0 +1,200 @@
+#include <algorithm>
+#include "VulkanLayoutCache.hpp"
+#include "VulkanRenderer.hpp"
+#include "../hash.hpp"
+
+using namespace giygas;
+using namespace std;
+
+class DescriptorSetLayoutSafeDeletable final : public SwapchainSafeDeleteable {
+
+    VkDescriptorSetLayout _layout;
+
+public:
+
+    explicit DescriptorSetLayoutSafeDeletable(VkDescriptorSetLayout layout) {
+        _layout = layout;
+    }
+
+    void delete_resources(VulkanRenderer &renderer) override {
+        vkDestroyDescriptorSetLayout(renderer.device(), _layout, nullptr);
+    }
+
+};
+
+class PipelineLayoutSafeDeletable final : public SwapchainSafeDeleteable {
+
+    VkPipelineLayout _layout;
+
+public:
+
+    explicit PipelineLayoutSafeDeletable(VkPipelineLayout layout) {
+        _layout = layout;
+    }
+
+    void delete_resources(VulkanRenderer &renderer) override {
+        vkDestroyPipelineLayout(renderer.device(), _layout, nullptr);
+    }
+
+};
+
+size_t VulkanLayoutKeyHash::operator()(const vector<uint64_t> &key) const {
+    uint64_t hash = 0;
+    for (uint64_t word : key) {
+        hash = mix_bits(hash ^ word);
+    }
+    return static_cast<size_t>(hash);
+}
+
+//
+// VulkanDescriptorSetLayout implementation
+//
+
+VulkanDescriptorSetLayout::VulkanDescriptorSetLayout(
+    VulkanRenderer *renderer,
+    VulkanLayoutCache *cache,
+    vector<uint64_t> key
+) {
+    _renderer = renderer;
+    _cache = cache;
+    _key = move(key);
+    handle = VK_NULL_HANDLE;
+    id = renderer->make_object_id();
+}
+
+VulkanDescriptorSetLayout::~VulkanDescriptorSetLayout() {
+    _cache->remove_descriptor_set_layout(_key);
+    if (handle != VK_NULL_HANDLE) {
+        _renderer->delete_when_safe(unique_ptr<SwapchainSafeDeleteable>(
+            new DescriptorSetLayoutSafeDeletable(handle)
+        ));
+    }
+}
+
+//
+// VulkanPipelineLayout implementation
+//
+
+VulkanPipelineLayout::VulkanPipelineLayout(
+    VulkanRenderer *renderer,
+    VulkanLayoutCache *cache,
+    vector<uint64_t> key
+) {
+    _renderer = renderer;
+    _cache = cache;
+    _key = move(key);
+    handle = VK_NULL_HANDLE;
+}
+
+VulkanPipelineLayout::~VulkanPipelineLayout() {
+    _cache->remove_pipeline_layout(_key);
+    if (handle != VK_NULL_HANDLE) {
+        _renderer->delete_when_safe(unique_ptr<SwapchainSafeDeleteable>(
+            new PipelineLayoutSafeDeletable(handle)
+        ));
+    }
+}
+
+//
+// VulkanLayoutCache implementation
+//
+
+void VulkanLayoutCache::create(VulkanRenderer *renderer) {
+    _renderer = renderer;
+}
+
+shared_ptr<const VulkanDescriptorSetLayout> VulkanLayoutCache::get_descriptor_set_layout(
+    const VkDescriptorSetLayoutBinding *bindings,
+    const uint64_t *immutable_sampler_ids,
+    uint32_t binding_count
+) {
+    // Bindings are keyed in order of binding index, as Vulkan does not care about the order they are given in.
+    vector<uint32_t> order(binding_count);
+    for (uint32_t i = 0; i < binding_count; ++i) {
+        order[i] = i;
+    }
+    sort(order.begin(), order.end(), [bindings](uint32_t a, uint32_t b) {
+        return bindings[a].binding < bindings[b].binding;
+    });
+
+    vector<uint64_t> key;
+    key.reserve(binding_count * 5);
+    for (uint32_t i : order) {
+        const VkDescriptorSetLayoutBinding &binding = bindings[i];
+        key.push_back(binding.binding);
+        key.push_back(static_cast<uint64_t>(binding.descriptorType));
+        key.push_back(binding.descriptorCount);
+        key.push_back(binding.stageFlags);
+        key.push_back(immutable_sampler_ids[i]);
+    }
+
+    lock_guard<mutex> _(_mutex);
+    weak_ptr<const VulkanDescriptorSetLayout> &entry = _descriptor_set_layouts[key];
+    shared_ptr<const VulkanDescriptorSetLayout> existing = entry.lock();
+    if (existing != nullptr) {
+        return existing;
+    }
+
+    shared_ptr<VulkanDescriptorSetLayout> layout = make_shared<VulkanDescriptorSetLayout>(_renderer, this, key);
+    VkDescriptorSetLayoutCreateInfo layout_info = {};
+    layout_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layout_info.bindingCount = binding_count;
+    layout_info.pBindings = bindings;
+    if (vkCreateDescriptorSetLayout(_renderer->device(), &layout_info, nullptr, &layout->handle) == VK_SUCCESS) {
+        entry = layout;
+    }
+    return layout;
+}
+
+shared_ptr<const VulkanPipelineLayout> VulkanLayoutCache::get_pipeline_layout(
+    const shared_ptr<const VulkanDescriptorSetLayout> &descriptor_set_layout,
+    const VkPushConstantRange *push_constant_ranges,
+    uint32_t push_constant_range_count
+) {
+    vector<uint64_t> key;
+    key.reserve(1 + push_constant_range_count * 3);
+    key.push_back(descriptor_set_layout != nullptr ? descriptor_set_layout->id : 0);
+    for (uint32_t i = 0; i < push_constant_range_count; ++i) {
+        const VkPushConstantRange &range = push_constant_ranges[i];
+        key.push_back(range.stageFlags);
+        key.push_back(range.offset);
+        key.push_back(range.size);
+    }
+
+    lock_guard<mutex> _(_mutex);
+    weak_ptr<const VulkanPipelineLayout> &entry = _pipeline_layouts[key];
+    shared_ptr<const VulkanPipelineLayout> existing = entry.lock();
+    if (existing != nullptr) {
+        return existing;
+    }
+
+    shared_ptr<VulkanPipelineLayout> layout = make_shared<VulkanPipelineLayout>(_renderer, this, key);
+    layout->descriptor_set_layout = descriptor_set_layout;
+
+    VkPipelineLayoutCreateInfo layout_info = {};
+    layout_info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    layout_info.setLayoutCount = descriptor_set_layout != nullptr ? 1 : 0;
+    layout_info.pSetLayouts = descriptor_set_layout != nullptr ? &descriptor_set_layout->handle : nullptr;
+    layout_info.pushConstantRangeCount = push_constant_range_count;
+    layout_info.pPushConstantRanges = push_constant_ranges;
+    if (vkCreatePipelineLayout(_renderer->device(), &layout_info, nullptr, &layout->handle) == VK_SUCCESS) {
+        entry = layout;
+    }
+    return layout;
+}
+
+void VulkanLayoutCache::remove_descriptor_set_layout(const vector<uint64_t> &key) {
+    lock_guard<mutex> _(_mutex);
+    auto found = _descriptor_set_layouts.find(key);
+    if (found != _descriptor_set_layouts.end() && found->second.expired()) {
+        _descriptor_set_layouts.erase(found);
+    }
+}
+
+void VulkanLayoutCache::remove_pipeline_layout(const vector<uint64_t> &key) {
+    lock_guard<mutex> _(_mutex);
+    auto found = _pipeline_layouts.find(key);
+    if (found != _pipeline_layouts.end() && found->second.expired()) {
+        _pipeline_layouts.erase(found);
+    }
+}
@@ -0,0 +1,114 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace giygas {
+
+    class VulkanRenderer;
+    class VulkanLayoutCache;
+
+    class VulkanLayoutKeyHash {
+    public:
+        size_t operator()(const std::vector<uint64_t> &key) const;
+    };
+
+    // A descriptor set layout shared by every descriptor set and pipeline with the same bindings. Layouts are only
+    // ever made by the cache, so two sets or pipelines have compatible layouts exactly when they point to the same
+    // VulkanDescriptorSetLayout.
+    class VulkanDescriptorSetLayout final {
+
+        VulkanRenderer *_renderer;
+        VulkanLayoutCache *_cache;
+        std::vector<uint64_t> _key;
+
+    public:
+        VkDescriptorSetLayout handle;
+
+        // Identifies the layout for as long as the renderer lives, unlike the handle.
+        uint64_t id;
+
+        VulkanDescriptorSetLayout(VulkanRenderer *renderer, VulkanLayoutCache *cache, std::vector<uint64_t> key);
+        VulkanDescriptorSetLayout(const VulkanDescriptorSetLayout &) = delete;
+        VulkanDescriptorSetLayout &operator=(const VulkanDescriptorSetLayout &) = delete;
+        VulkanDescriptorSetLayout(VulkanDescriptorSetLayout &&) noexcept = delete;
+        VulkanDescriptorSetLayout &operator=(VulkanDescriptorSetLayout &&) noexcept = delete;
+        ~VulkanDescriptorSetLayout();
+    };
+
+    // A pipeline layout shared by every pipeline with the same descriptor set layout and push constant ranges.
+    class VulkanPipelineLayout final {
+
+        VulkanRenderer *_renderer;
+        VulkanLayoutCache *_cache;
+        std::vector<uint64_t> _key;
+
+    public:
+        VkPipelineLayout handle;
+
+        // Null for pipelines without a descriptor set.
+        std::shared_ptr<const VulkanDescriptorSetLayout> descriptor_set_layout;
+
+        VulkanPipelineLayout(VulkanRenderer *renderer, VulkanLayoutCache *cache, std::vector<uint64_t> key);
+        VulkanPipelineLayout(const VulkanPipelineLayout &) = delete;
+        VulkanPipelineLayout &operator=(const VulkanPipelineLayout &) = delete;
+        VulkanPipelineLayout(VulkanPipelineLayout &&) noexcept = delete;
+        VulkanPipelineLayout &operator=(VulkanPipelineLayout &&) noexcept = delete;
+        ~VulkanPipelineLayout();
+    };
+
+    // Hash consed descriptor set and pipeline layouts. The cache only holds weak references; layouts live as long as
+    // the descriptor sets and pipelines using them. May be used from any thread.
+    class VulkanLayoutCache final {
+
+        using DescriptorSetLayoutMap = std::unordered_map<
+            std::vector<uint64_t>,
+            std::weak_ptr<const VulkanDescriptorSetLayout>,
+            VulkanLayoutKeyHash
+        >;
+        using PipelineLayoutMap = std::unordered_map<
+            std::vector<uint64_t>,
+            std::weak_ptr<const VulkanPipelineLayout>,
+            VulkanLayoutKeyHash
+        >;
+
+        VulkanRenderer *_renderer = nullptr;
+        std::mutex _mutex;
+        DescriptorSetLayoutMap _descriptor_set_layouts;
+        PipelineLayoutMap _pipeline_layouts;
+
+    public:
+        VulkanLayoutCache() = default;
+        VulkanLayoutCache(const VulkanLayoutCache &) = delete;
+        VulkanLayoutCache &operator=(const VulkanLayoutCache &) = delete;
+        VulkanLayoutCache(VulkanLayoutCache &&) noexcept = delete;
+        VulkanLayoutCache &operator=(VulkanLayoutCache &&) noexcept = delete;
+
+        void create(VulkanRenderer *renderer);
+
+        // Returns the layout with the given bindings, making it when there is none. The order of the bindings does not
+        // matter. immutable_sampler_ids holds each binding's immutable sampler id, or 0 for bindings without one.
+        std::shared_ptr<const VulkanDescriptorSetLayout> get_descriptor_set_layout(
+            const VkDescriptorSetLayoutBinding *bindings,
+            const uint64_t *immutable_sampler_ids,
+            uint32_t binding_count
+        );
+
+        // Returns the pipeline layout with the given descriptor set layout, which may be null, and push constant
+        // ranges, making it when there is none.
+        std::shared_ptr<const VulkanPipelineLayout> get_pipeline_layout(
+            const std::shared_ptr<const VulkanDescriptorSetLayout> &descriptor_set_layout,
+            const VkPushConstantRange *push_constant_ranges,
+            uint32_t push_constant_range_count
+        );
+
+        // Called by layouts as they are destroyed. Keys which have been taken over by a live layout are kept.
+        void remove_descriptor_set_layout(const std::vector<uint64_t> &key);
+        void remove_pipeline_layout(const std::vector<uint64_t> &key);
+    };
+
+}
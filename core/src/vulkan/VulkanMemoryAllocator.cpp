@@ -0,0 +1,159 @@
+#include <algorithm>
+#include <cassert>
+#include <iterator>
+#include "VulkanMemoryAllocator.hpp"
+
+using namespace giygas;
+using namespace std;
+
+VulkanMemoryAllocator::~VulkanMemoryAllocator() {
+    destroy();
+}
+
+void VulkanMemoryAllocator::create(VkDevice device, const VkPhysicalDeviceMemoryProperties &memory_properties) {
+    _device = device;
+    _memory_properties = memory_properties;
+
+    for (uint32_t i = 0; i < memory_properties.memoryTypeCount; ++i) {
+        const VkMemoryHeap &heap = memory_properties.memoryHeaps[memory_properties.memoryTypes[i].heapIndex];
+        VkDeviceSize block_size = choose_block_size(heap.size);
+        _pools[i * 2].block_size = block_size;
+        _pools[i * 2 + 1].block_size = block_size;
+    }
+}
+
+void VulkanMemoryAllocator::destroy() {
+    if (_device == VK_NULL_HANDLE) {
+        return;
+    }
+
+    for (Pool &pool : _pools) {
+        for (const unique_ptr<Block> &block : pool.blocks) {
+            vkFreeMemory(_device, block->memory, nullptr);
+        }
+        pool.blocks.clear();
+    }
+    fill(begin(_heap_usage), end(_heap_usage), 0);
+    _device = VK_NULL_HANDLE;
+}
+
+bool VulkanMemoryAllocator::allocate(
+    const VkMemoryRequirements &requirements,
+    uint32_t memory_type,
+    bool is_linear,
+    VulkanAllocation &allocation
+) {
+    assert(memory_type < _memory_properties.memoryTypeCount);
+
+    allocation = {};
+    allocation.size = requirements.size;
+    allocation.alignment = requirements.alignment;
+    allocation.memory_type = memory_type;
+    allocation.is_linear = is_linear;
+
+    lock_guard<mutex> _(_mutex);
+    Pool &pool = _pools[memory_type * 2 + (is_linear ? 1 : 0)];
+
+    // Resources larger than a block get their own allocation.
+    if (BuddyAllocator::region_size(requirements.size, requirements.alignment, min_region_size) > pool.block_size) {
+        allocation.is_dedicated = true;
+        return allocate_device_memory(requirements.size, memory_type, allocation.memory, allocation.mapped);
+    }
+
+    for (const unique_ptr<Block> &block : pool.blocks) {
+        if (block->allocator.allocate(requirements.size, requirements.alignment, allocation.offset)) {
+            allocation.memory = block->memory;
+            allocation.mapped = block->mapped == nullptr ? nullptr : block->mapped + allocation.offset;
+            return true;
+        }
+    }
+
+    unique_ptr<Block> block(new Block());
+    if (!allocate_device_memory(pool.block_size, memory_type, block->memory, block->mapped)) {
+        return false;
+    }
+    block->allocator = BuddyAllocator(pool.block_size, min_region_size);
+    block->allocator.allocate(requirements.size, requirements.alignment, allocation.offset);
+    allocation.memory = block->memory;
+    allocation.mapped = block->mapped == nullptr ? nullptr : block->mapped + allocation.offset;
+    pool.blocks.push_back(move(block));
+    return true;
+}
+
+void VulkanMemoryAllocator::free(const VulkanAllocation &allocation) {
+    if (allocation.memory == VK_NULL_HANDLE) {
+        return;
+    }
+
+    lock_guard<mutex> _(_mutex);
+    if (allocation.is_dedicated) {
+        free_device_memory(allocation.size, allocation.memory_type, allocation.memory);
+        return;
+    }
+
+    Pool &pool = _pools[allocation.memory_type * 2 + (allocation.is_linear ? 1 : 0)];
+    for (size_t i = 0; i < pool.blocks.size(); ++i) {
+        Block &block = *pool.blocks[i];
+        if (block.memory != allocation.memory) {
+            continue;
+        }
+
+        block.allocator.free(allocation.offset, allocation.size, allocation.alignment);
+
+        // Keep one empty block around per pool, so a resource being recreated does not reallocate device memory.
+        if (block.allocator.is_empty() && pool.blocks.size() > 1) {
+            free_device_memory(pool.block_size, allocation.memory_type, block.memory);
+            pool.blocks.erase(pool.blocks.begin() + i);
+        }
+        return;
+    }
+
+    // Giygas bug
+    assert(false);
+}
+
+bool VulkanMemoryAllocator::allocate_device_memory(
+    VkDeviceSize size,
+    uint32_t memory_type,
+    VkDeviceMemory &memory,
+    uint8_t *&mapped
+) {
+    VkMemoryAllocateInfo alloc_info = {};
+    alloc_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    alloc_info.allocationSize = size;
+    alloc_info.memoryTypeIndex = memory_type;
+    if (vkAllocateMemory(_device, &alloc_info, nullptr, &memory) != VK_SUCCESS) {
+        memory = VK_NULL_HANDLE;
+        return false;
+    }
+    _heap_usage[_memory_properties.memoryTypes[memory_type].heapIndex] += size;
+
+    mapped = nullptr;
+    if (_memory_properties.memoryTypes[memory_type].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) {
+        void *mapped_memory = nullptr;
+        if (vkMapMemory(_device, memory, 0, VK_WHOLE_SIZE, 0, &mapped_memory) == VK_SUCCESS) {
+            mapped = static_cast<uint8_t *>(mapped_memory);
+        }
+    }
+    return true;
+}
+
+void VulkanMemoryAllocator::free_device_memory(VkDeviceSize size, uint32_t memory_type, VkDeviceMemory memory) {
+    vkFreeMemory(_device, memory, nullptr);
+    _heap_usage[_memory_properties.memoryTypes[memory_type].heapIndex] -= size;
+}
+
+void VulkanMemoryAllocator::heap_usage(VkDeviceSize *usage) {
+    lock_guard<mutex> _(_mutex);
+    copy(begin(_heap_usage), end(_heap_usage), usage);
+}
+
+VkDeviceSize VulkanMemoryAllocator::choose_block_size(VkDeviceSize heap_size) {
+    // Small heaps, such as the host visible device local window without resizable BAR, get an eighth of the heap
+    // per block so a few blocks do not exhaust them.
+    VkDeviceSize block_size = max_block_size;
+    while (block_size > min_region_size && block_size > heap_size / 8) {
+        block_size /= 2;
+    }
+    return block_size;
+}
@@ -0,0 +1,83 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "../BuddyAllocator.hpp"
+
+namespace giygas {
+
+    // A range of device memory handed out by VulkanMemoryAllocator. Host visible allocations are persistently mapped,
+    // since the block they live in can only be mapped once.
+    class VulkanAllocation {
+    public:
+        VkDeviceMemory memory = VK_NULL_HANDLE;
+        VkDeviceSize offset = 0;
+        VkDeviceSize size = 0;
+        VkDeviceSize alignment = 0;
+        uint8_t *mapped = nullptr;
+        uint32_t memory_type = 0;
+        bool is_linear = false;
+        bool is_dedicated = false;
+    };
+
+    // Suballocates buffers and images from large device memory blocks, keeping the number of vkAllocateMemory calls
+    // far below maxMemoryAllocationCount. Each memory type has its own pools, placement within a block is done by a
+    // buddy allocator, and resources too large for a block get a dedicated allocation. Safe to use from any thread.
+    class VulkanMemoryAllocator final {
+
+        class Block {
+        public:
+            VkDeviceMemory memory = VK_NULL_HANDLE;
+            uint8_t *mapped = nullptr;
+            BuddyAllocator allocator;
+        };
+
+        class Pool {
+        public:
+            VkDeviceSize block_size = 0;
+            std::vector<std::unique_ptr<Block>> blocks;
+        };
+
+        VkDevice _device = VK_NULL_HANDLE;
+        VkPhysicalDeviceMemoryProperties _memory_properties = {};
+        std::mutex _mutex;
+
+        // Linear resources (buffers) and optimal tiling images never share a block, so bufferImageGranularity never
+        // has to be considered between neighbours. Indexed by memory type * 2 + is_linear.
+        Pool _pools[VK_MAX_MEMORY_TYPES * 2];
+
+        // Bytes of device memory allocated from each heap, counting whole blocks.
+        VkDeviceSize _heap_usage[VK_MAX_MEMORY_HEAPS] = {};
+
+        static const VkDeviceSize max_block_size = 64 * 1024 * 1024;
+        static const VkDeviceSize min_region_size = 256;
+
+        bool allocate_device_memory(VkDeviceSize size, uint32_t memory_type, VkDeviceMemory &memory, uint8_t *&mapped);
+        void free_device_memory(VkDeviceSize size, uint32_t memory_type, VkDeviceMemory memory);
+        static VkDeviceSize choose_block_size(VkDeviceSize heap_size);
+
+    public:
+        VulkanMemoryAllocator() = default;
+        VulkanMemoryAllocator(const VulkanMemoryAllocator &) = delete;
+        VulkanMemoryAllocator &operator=(const VulkanMemoryAllocator &) = delete;
+        VulkanMemoryAllocator(VulkanMemoryAllocator &&) noexcept = delete;
+        VulkanMemoryAllocator &operator=(VulkanMemoryAllocator &&) noexcept = delete;
+        ~VulkanMemoryAllocator();
+
+        void create(VkDevice device, const VkPhysicalDeviceMemoryProperties &memory_properties);
+        void destroy();
+
+        bool allocate(
+            const VkMemoryRequirements &requirements,
+            uint32_t memory_type,
+            bool is_linear,
+            VulkanAllocation &allocation
+        );
+        void free(const VulkanAllocation &allocation);
+
+        // Copies the bytes allocated from each heap into usage, which has room for VK_MAX_MEMORY_HEAPS entries.
+        void heap_usage(VkDeviceSize *usage);
+    };
+
+}
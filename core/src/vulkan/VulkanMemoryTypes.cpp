@@ -0,0 +1,81 @@
+#include "VulkanMemoryTypes.hpp"
+
+using namespace giygas;
+
+// Flags which change what memory can be used for, so a type having them is only picked when they are required.
+static const VkMemoryPropertyFlags restrictive_flags = VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT
+#ifdef VK_VERSION_1_1
+    | VK_MEMORY_PROPERTY_PROTECTED_BIT
+#endif
+    ;
+
+static uint32_t count_flags(VkMemoryPropertyFlags flags) {
+    uint32_t count = 0;
+    for (; flags != 0; flags &= flags - 1) {
+        ++count;
+    }
+    return count;
+}
+
+class MemoryTypeScore {
+public:
+    bool is_within_budget = false;
+    uint32_t preferred_count = 0;
+    uint32_t unrequested_count = 0;
+
+    bool is_better_than(const MemoryTypeScore &other) const {
+        if (is_within_budget != other.is_within_budget) {
+            return is_within_budget;
+        }
+        if (preferred_count != other.preferred_count) {
+            return preferred_count > other.preferred_count;
+        }
+        return unrequested_count < other.unrequested_count;
+    }
+};
+
+VkDeviceSize giygas::memory_heap_budget(const VkMemoryHeap &heap) {
+    return heap.size - heap.size / 5;
+}
+
+bool giygas::choose_memory_type(
+    const VkPhysicalDeviceMemoryProperties &memory_properties,
+    const VkDeviceSize *heap_usage,
+    uint32_t type_filter,
+    const VulkanMemoryRequest &request,
+    VkDeviceSize size,
+    uint32_t &memory_type
+) {
+    bool found = false;
+    MemoryTypeScore best_score;
+
+    for (uint32_t i = 0; i < memory_properties.memoryTypeCount; ++i) {
+        const VkMemoryType &type = memory_properties.memoryTypes[i];
+        if ((type_filter & (1u << i)) == 0
+            || (type.propertyFlags & request.required) != request.required
+            || (type.propertyFlags & restrictive_flags & ~request.required) != 0
+        ) {
+            continue;
+        }
+
+        MemoryTypeScore score;
+        if (heap_usage == nullptr) {
+            score.is_within_budget = true;
+        } else {
+            VkDeviceSize budget = memory_heap_budget(memory_properties.memoryHeaps[type.heapIndex]);
+            VkDeviceSize used = heap_usage[type.heapIndex];
+            score.is_within_budget = used <= budget && budget - used >= size;
+        }
+        score.preferred_count = count_flags(type.propertyFlags & request.preferred);
+        score.unrequested_count = count_flags(type.propertyFlags & ~(request.required | request.preferred));
+
+        // Ties go to the lower index, which the spec orders by performance.
+        if (!found || score.is_better_than(best_score)) {
+            found = true;
+            best_score = score;
+            memory_type = i;
+        }
+    }
+
+    return found;
+}
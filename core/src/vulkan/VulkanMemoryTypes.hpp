@@ -0,0 +1,29 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include <cstdint>
+
+namespace giygas {
+
+    // Memory property flags a resource can not do without, and flags it runs faster with.
+    class VulkanMemoryRequest {
+    public:
+        VkMemoryPropertyFlags required = 0;
+        VkMemoryPropertyFlags preferred = 0;
+    };
+
+    // Bytes of a heap the renderer allows itself to allocate. The rest is left to other processes and the driver.
+    VkDeviceSize memory_heap_budget(const VkMemoryHeap &heap);
+
+    // Picks the memory type in type_filter best suited to a request of size bytes, never one without every required
+    // flag. Types whose heap has room left in its budget, which heap_usage may be null to ignore, come first, then
+    // types with more preferred flags, then those with fewer unrequested flags. Returns false when no type fits.
+    bool choose_memory_type(
+        const VkPhysicalDeviceMemoryProperties &memory_properties,
+        const VkDeviceSize *heap_usage,
+        uint32_t type_filter,
+        const VulkanMemoryRequest &request,
+        VkDeviceSize size,
+        uint32_t &memory_type
+    );
+
+}
@@ -0,0 +1,167 @@
+#include <cstdint>
+#include <cassert>
+#include "VulkanOffscreenSwapchain.hpp"
+#include "VulkanRenderer.hpp"
+
+using namespace giygas;
+
+VulkanOffscreenSwapchain::VulkanOffscreenSwapchain()
+    : _rendertarget(this)
+{
+    _renderer = nullptr;
+    _image_count = 0;
+    _format = VK_FORMAT_UNDEFINED;
+    _extent = {};
+}
+
+VulkanOffscreenSwapchain::~VulkanOffscreenSwapchain() {
+    destroy();
+}
+
+uint32_t VulkanOffscreenSwapchain::width() const {
+    return _extent.width;
+}
+
+uint32_t VulkanOffscreenSwapchain::height() const {
+    return _extent.height;
+}
+
+bool VulkanOffscreenSwapchain::create(
+    VulkanRenderer *renderer,
+    VkFormat format,
+    VkExtent2D extent,
+    uint32_t image_count
+) {
+    _renderer = renderer;
+    _format = format;
+    _extent = extent;
+    _image_count = image_count;
+
+    _images = unique_ptr<VkImage[]>(new VkImage[image_count]);
+    _image_memories = unique_ptr<VkDeviceMemory[]>(new VkDeviceMemory[image_count]);
+    _image_views = unique_ptr<VkImageView[]>(new VkImageView[image_count]);
+
+    for (uint32_t i = 0; i < image_count; ++i) {
+        _images[i] = VK_NULL_HANDLE;
+        _image_memories[i] = VK_NULL_HANDLE;
+        _image_views[i] = VK_NULL_HANDLE;
+    }
+
+    for (uint32_t i = 0; i < image_count; ++i) {
+        if (create_image(i) != VK_SUCCESS) {
+            return false;
+        }
+        if (create_image_view(i) != VK_SUCCESS) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void VulkanOffscreenSwapchain::destroy() {
+    if (_renderer == nullptr) {
+        return;
+    }
+    VkDevice device = _renderer->device();
+    for (uint32_t i = 0; i < _image_count; ++i) {
+        vkDestroyImageView(device, _image_views[i], nullptr);
+        vkDestroyImage(device, _images[i], nullptr);
+        vkFreeMemory(device, _image_memories[i], nullptr);
+    }
+    _image_count = 0;
+    _images = nullptr;
+    _image_memories = nullptr;
+    _image_views = nullptr;
+    _renderer = nullptr;
+}
+
+uint32_t VulkanOffscreenSwapchain::image_count() const {
+    return _image_count;
+}
+
+VkFormat VulkanOffscreenSwapchain::format() const {
+    return _format;
+}
+
+VkImage VulkanOffscreenSwapchain::get_image(uint32_t index) const {
+    assert(index < _image_count);
+    return _images[index];
+}
+
+VkImageView VulkanOffscreenSwapchain::get_image_view(uint32_t index) const {
+    assert(index < _image_count);
+    return _image_views[index];
+}
+
+const VulkanOffscreenSwapchainRenderTarget* VulkanOffscreenSwapchain::rendertarget() const {
+    return &_rendertarget;
+}
+
+VkResult VulkanOffscreenSwapchain::create_image(uint32_t index) {
+    VkDevice device = _renderer->device();
+
+    VkImageCreateInfo create_info = {};
+    create_info.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    create_info.imageType = VK_IMAGE_TYPE_2D;
+    create_info.extent.width = _extent.width;
+    create_info.extent.height = _extent.height;
+    create_info.extent.depth = 1;
+    create_info.mipLevels = 1;
+    create_info.arrayLayers = 1;
+    create_info.format = _format;
+    create_info.tiling = VK_IMAGE_TILING_OPTIMAL;
+    create_info.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    // Transfer source so the frame can be read back, e.g. for image comparison tests.
+    create_info.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+    create_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    create_info.samples = VK_SAMPLE_COUNT_1_BIT;
+
+    VkResult result = vkCreateImage(device, &create_info, nullptr, &_images[index]);
+    if (result != VK_SUCCESS) {
+        return result;
+    }
+
+    VkMemoryRequirements memory_requirements;
+    vkGetImageMemoryRequirements(device, _images[index], &memory_requirements);
+
+    uint32_t memory_type;
+    if (!_renderer->find_memory_type(
+        memory_requirements.memoryTypeBits,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+        memory_type
+    )) {
+        return VK_ERROR_OUT_OF_DEVICE_MEMORY;
+    }
+
+    VkMemoryAllocateInfo alloc_info = {};
+    alloc_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    alloc_info.allocationSize = memory_requirements.size;
+    alloc_info.memoryTypeIndex = memory_type;
+
+    result = vkAllocateMemory(device, &alloc_info, nullptr, &_image_memories[index]);
+    if (result != VK_SUCCESS) {
+        return result;
+    }
+
+    return vkBindImageMemory(device, _images[index], _image_memories[index], 0);
+}
+
+VkResult VulkanOffscreenSwapchain::create_image_view(uint32_t index) {
+    VkImageViewCreateInfo create_info = {};
+    create_info.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+    create_info.image = _images[index];
+    create_info.viewType = VK_IMAGE_VIEW_TYPE_2D;
+    create_info.format = _format;
+    create_info.components.r = VK_COMPONENT_SWIZZLE_IDENTITY;
+    create_info.components.g = VK_COMPONENT_SWIZZLE_IDENTITY;
+    create_info.components.b = VK_COMPONENT_SWIZZLE_IDENTITY;
+    create_info.components.a = VK_COMPONENT_SWIZZLE_IDENTITY;
+    create_info.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    create_info.subresourceRange.baseMipLevel = 0;
+    create_info.subresourceRange.levelCount = 1;
+    create_info.subresourceRange.baseArrayLayer = 0;
+    create_info.subresourceRange.layerCount = 1;
+
+    return vkCreateImageView(_renderer->device(), &create_info, nullptr, &_image_views[index]);
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include <memory>
+#include "VulkanOffscreenSwapchainRenderTarget.hpp"
+
+namespace giygas {
+    using namespace std;
+
+    class VulkanRenderer;
+
+    // Stands in for VulkanSwapchain when the renderer is headless. Owns a fixed ring of color images which are
+    // rendered to in submission order and never presented.
+    class VulkanOffscreenSwapchain {
+
+        VulkanRenderer *_renderer;
+        uint32_t _image_count;
+        unique_ptr<VkImage[]> _images;
+        unique_ptr<VkDeviceMemory[]> _image_memories;
+        unique_ptr<VkImageView[]> _image_views;
+        VulkanOffscreenSwapchainRenderTarget _rendertarget;
+        VkFormat _format;
+        VkExtent2D _extent;
+
+        VkResult create_image(uint32_t index);
+        VkResult create_image_view(uint32_t index);
+
+    public:
+        explicit VulkanOffscreenSwapchain();
+        VulkanOffscreenSwapchain(const VulkanOffscreenSwapchain &) = delete;
+        VulkanOffscreenSwapchain &operator=(const VulkanOffscreenSwapchain &) = delete;
+        VulkanOffscreenSwapchain(VulkanOffscreenSwapchain &&) = delete;
+        VulkanOffscreenSwapchain &operator=(VulkanOffscreenSwapchain &&) = delete;
+        ~VulkanOffscreenSwapchain();
+
+        uint32_t width() const;
+        uint32_t height() const;
+
+        bool create(
+            VulkanRenderer *renderer,
+            VkFormat format,
+            VkExtent2D extent,
+            uint32_t image_count
+        );
+
+        void destroy();
+
+        uint32_t image_count() const;
+        VkFormat format() const;
+        VkImage get_image(uint32_t index) const;
+        VkImageView get_image_view(uint32_t index) const;
+        const VulkanOffscreenSwapchainRenderTarget *rendertarget() const;
+
+    };
+
+}
@@ -0,0 +1,42 @@
+#include <giygas/RendererType.hpp>
+#include "VulkanOffscreenSwapchainRenderTarget.hpp"
+#include "VulkanOffscreenSwapchain.hpp"
+
+using namespace giygas;
+
+VulkanOffscreenSwapchainRenderTarget::VulkanOffscreenSwapchainRenderTarget(const VulkanOffscreenSwapchain *swapchain) {
+    _swapchain = swapchain;
+}
+
+RendererType VulkanOffscreenSwapchainRenderTarget::renderer_type() const {
+    return RendererType::Vulkan;
+}
+
+const void* VulkanOffscreenSwapchainRenderTarget::rendertarget_impl() const {
+    return static_cast<const VulkanRenderTarget *>(this);
+}
+
+uint32_t VulkanOffscreenSwapchainRenderTarget::width() const {
+    return _swapchain->width();
+}
+
+uint32_t VulkanOffscreenSwapchainRenderTarget::height() const {
+    return _swapchain->height();
+}
+
+VkImageView VulkanOffscreenSwapchainRenderTarget::image_view(uint32_t index) const {
+    return _swapchain->get_image_view(index);
+}
+
+VkImageLayout VulkanOffscreenSwapchainRenderTarget::layout() const {
+    return VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+}
+
+VkFormat VulkanOffscreenSwapchainRenderTarget::api_format() const {
+    return _swapchain->format();
+}
+
+bool VulkanOffscreenSwapchainRenderTarget::is_swapchain() const {
+    // Behaves as the swapchain, so framebuffers are created per image in the ring.
+    return true;
+}
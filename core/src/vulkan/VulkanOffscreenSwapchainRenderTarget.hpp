@@ -0,0 +1,39 @@
+#pragma once
+#include <cstdint>
+#include <vulkan/vulkan.h>
+#include "VulkanRenderTarget.hpp"
+
+namespace giygas {
+
+    class VulkanOffscreenSwapchain;
+
+    class VulkanOffscreenSwapchainRenderTarget final : public VulkanRenderTarget {
+
+        const VulkanOffscreenSwapchain *_swapchain = nullptr;
+
+    public:
+
+        VulkanOffscreenSwapchainRenderTarget(const VulkanOffscreenSwapchain *swapchain);
+
+        //
+        // RenderTarget implementation
+        //
+
+        RendererType renderer_type() const override;
+        const void *rendertarget_impl() const override;
+        uint32_t width() const override;
+        uint32_t height() const override;
+
+
+        //
+        // VulkanRenderTarget implementation
+        //
+
+        VkImageView image_view(uint32_t index) const override;
+        VkImageLayout layout() const override;
+        VkFormat api_format() const override;
+        bool is_swapchain() const override;
+
+    };
+
+}
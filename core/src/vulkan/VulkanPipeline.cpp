@@ -11,42 +11,30 @@ using namespace giygas::validation;
 using namespace std;
 
 
-class PipelineSafeDeletable final : public SwapchainSafeDeleteable {
-
-    VkPipeline _pipeline;
-    VkPipelineLayout _layout;
-
-public:
-
-    PipelineSafeDeletable(VkPipeline pipeline, VkPipelineLayout layout) {
-        _pipeline = pipeline;
-        _layout = layout;
-    }
-
-    void delete_resources(VulkanRenderer &renderer) override {
-        VkDevice device = renderer.device();
-        vkDestroyPipeline(device, _pipeline, nullptr);
-        vkDestroyPipelineLayout(device, _layout, nullptr);
-    }
-
-};
-
-
-
 VulkanPipeline::VulkanPipeline(VulkanRenderer *renderer) {
     _renderer = renderer;
-    _layout = VK_NULL_HANDLE;
-    _handle = VK_NULL_HANDLE;
-    _descriptor_set_layout = VK_NULL_HANDLE;
-}
-
-VulkanPipeline::~VulkanPipeline() {
-    _renderer->delete_when_safe(unique_ptr<SwapchainSafeDeleteable>(new PipelineSafeDeletable(_handle, _layout)));
 }
 
 void VulkanPipeline::create(const PipelineCreateParameters &params) {
     assert(validate_pipeline_create(this, params));
 
+    // Pipelines created with the same parameters share their backend objects.
+    VulkanPipelineStateCache &cache = _renderer->pipeline_states();
+    VulkanPipelineKey key(params);
+    _state = cache.find(key);
+    if (_state != nullptr) {
+        return;
+    }
+
+    shared_ptr<VulkanPipelineState> state = make_shared<VulkanPipelineState>(_renderer);
+    create_state(params, *state);
+    if (state->handle != VK_NULL_HANDLE) {
+        state = cache.add(key, move(state));
+    }
+    _state = move(state);
+}
+
+void VulkanPipeline::create_state(const PipelineCreateParameters &params, VulkanPipelineState &state) const {
     VkDevice device = _renderer->device();
 
     unique_ptr<VkVertexInputBindingDescription[]> input_bindings(
@@ -73,7 +61,7 @@ void VulkanPipeline::create(const PipelineCreateParameters &params) {
         binding = {};
         binding.binding = binding_index;
         binding.stride = static_cast<uint32_t>(layout.stride);
-        binding.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+        binding.inputRate = translate_input_rate(layout.input_rate);
 
         for (size_t i = 0; i < layout.attribute_count; ++i) {
             const VertexAttribute &attrib = layout.attributes[i];
@@ -102,24 +90,13 @@ void VulkanPipeline::create(const PipelineCreateParameters &params) {
     input_assembly_info.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
     input_assembly_info.primitiveRestartEnable = VK_FALSE;
 
-    VkViewport viewport = {};
-    viewport.x = params.viewport.x;
-    viewport.y = params.viewport.y;
-    viewport.width = params.viewport.width;
-    viewport.height = params.viewport.height;
-    viewport.minDepth = params.viewport.min_depth;
-    viewport.maxDepth = params.viewport.max_depth;
-
-    VkRect2D scissor = {};
-    scissor.offset = { params.scissor.x, params.scissor.y };
-    scissor.extent = { params.scissor.width, params.scissor.height };
-
+    // The viewport and scissor are dynamic and set while recording, so pipelines work with any framebuffer size.
     VkPipelineViewportStateCreateInfo viewport_state = {};
     viewport_state.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
     viewport_state.viewportCount = 1;
-    viewport_state.pViewports = &viewport;
+    viewport_state.pViewports = nullptr;
     viewport_state.scissorCount = 1;
-    viewport_state.pScissors = &scissor;
+    viewport_state.pScissors = nullptr;
 
     VkPipelineRasterizationStateCreateInfo rasterizer = {};
     rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
@@ -191,8 +168,9 @@ void VulkanPipeline::create(const PipelineCreateParameters &params) {
     depth_stencil_state.minDepthBounds = 0;  // todo
     depth_stencil_state.maxDepthBounds = 1;  // todo
 
-    array<VkDynamicState, 0> dynamic_states = {
-        //VK_DYNAMIC_STATE_VIEWPORT
+    array<VkDynamicState, 2> dynamic_states = {
+        VK_DYNAMIC_STATE_VIEWPORT,
+        VK_DYNAMIC_STATE_SCISSOR
     };
 
     VkPipelineDynamicStateCreateInfo dynamic_state = {};
@@ -218,30 +196,19 @@ void VulkanPipeline::create(const PipelineCreateParameters &params) {
         range.offset = static_cast<uint32_t>(params.fragment_push_constants.offset);
         ++push_constant_range_count;
     }
-    _vertex_push_constants_range = params.vertex_push_constants;
-    _fragment_push_constants_range = params.fragment_push_constants;
+    state.vertex_push_constants_range = params.vertex_push_constants;
+    state.fragment_push_constants_range = params.fragment_push_constants;
 
-    uint32_t set_layout_count;
-    unique_ptr<VkDescriptorSetLayout[]> descriptor_set_layout_handles;
+    shared_ptr<const VulkanDescriptorSetLayout> descriptor_set_layout;
     if (params.descriptor_set != nullptr) {
-        set_layout_count = 1;
-        descriptor_set_layout_handles = unique_ptr<VkDescriptorSetLayout[]> (
-            new VkDescriptorSetLayout[set_layout_count]
-        );
-        const auto *descriptor_set_impl = reinterpret_cast<const VulkanDescriptorSet *>(params.descriptor_set);
-        descriptor_set_layout_handles[0] = descriptor_set_impl->layout();
-        _descriptor_set_layout = descriptor_set_impl->layout();
-    } else {
-        set_layout_count = 0;
+        descriptor_set_layout = static_cast<const VulkanDescriptorSet *>(params.descriptor_set)->layout();
     }
-
-    VkPipelineLayoutCreateInfo layout_info = {};
-    layout_info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-    layout_info.setLayoutCount = set_layout_count;
-    layout_info.pSetLayouts = descriptor_set_layout_handles.get();
-    layout_info.pushConstantRangeCount = push_constant_range_count;
-    layout_info.pPushConstantRanges = push_constant_ranges.data();
-    if (vkCreatePipelineLayout(device, &layout_info, nullptr, &_layout) != VK_SUCCESS) {
+    state.layout = _renderer->layouts().get_pipeline_layout(
+        descriptor_set_layout,
+        push_constant_ranges.data(),
+        push_constant_range_count
+    );
+    if (state.layout->handle == VK_NULL_HANDLE) {
         return;
     }
 
@@ -271,37 +238,41 @@ void VulkanPipeline::create(const PipelineCreateParameters &params) {
     pipeline_info.pMultisampleState = &multisample;
     pipeline_info.pDepthStencilState = &depth_stencil_state;
     pipeline_info.pColorBlendState = &color_blend;
-    pipeline_info.pDynamicState = nullptr; //&dynamic_state;
-    pipeline_info.layout = _layout;
+    pipeline_info.pDynamicState = &dynamic_state;
+    pipeline_info.layout = state.layout->handle;
     pipeline_info.renderPass = pass_impl->handle();
     pipeline_info.subpass = 0;
     pipeline_info.basePipelineHandle = VK_NULL_HANDLE;
     pipeline_info.basePipelineIndex = -1;
 
-    vkCreateGraphicsPipelines(device, VK_NULL_HANDLE, 1, &pipeline_info, nullptr, &_handle);
+    vkCreateGraphicsPipelines(device, _renderer->pipeline_cache(), 1, &pipeline_info, nullptr, &state.handle);
 }
 
 bool VulkanPipeline::is_valid() const {
-    return _handle != VK_NULL_HANDLE;
+    return _state != nullptr && _state->handle != VK_NULL_HANDLE;
 }
 
 uint8_t VulkanPipeline::descriptor_set_count() const {
-    return _descriptor_set_layout == VK_NULL_HANDLE ? uint8_t(0) : uint8_t(1);
+    assert(_state != nullptr);
+    return _state->layout == nullptr || _state->layout->descriptor_set_layout == nullptr ? uint8_t(0) : uint8_t(1);
 }
 
 bool VulkanPipeline::is_descriptor_set_compatible(const DescriptorSet *descriptor_set) const {
     assert(descriptor_set != nullptr);
     assert(descriptor_set->renderer_type() == RendererType::Vulkan);
     const auto *set_impl = reinterpret_cast<const VulkanDescriptorSet *>(descriptor_set);
-    return _descriptor_set_layout == set_impl->layout();
+    assert(_state != nullptr);
+    return _state->layout != nullptr && _state->layout->descriptor_set_layout == set_impl->layout();
 }
 
 PushConstantsRange VulkanPipeline::vertex_push_constants_range() const {
-    return _vertex_push_constants_range;
+    assert(_state != nullptr);
+    return _state->vertex_push_constants_range;
 }
 
 PushConstantsRange VulkanPipeline::fragment_push_constants_range() const {
-    return _fragment_push_constants_range;
+    assert(_state != nullptr);
+    return _state->fragment_push_constants_range;
 }
 
 RendererType VulkanPipeline::renderer_type() const {
@@ -309,11 +280,13 @@ RendererType VulkanPipeline::renderer_type() const {
 }
 
 VkPipeline VulkanPipeline::handle() const {
-    return _handle;
+    assert(_state != nullptr);
+    return _state->handle;
 }
 
 VkPipelineLayout VulkanPipeline::layout_handle() const {
-    return _layout;
+    assert(_state != nullptr);
+    return _state->layout->handle;
 }
 
 VkShaderStageFlagBits VulkanPipeline::shader_type_to_stage_flags(ShaderType type) {
@@ -353,6 +326,17 @@ VkFormat VulkanPipeline::get_attrib_format(size_t component_count) {
     }
 }
 
+VkVertexInputRate VulkanPipeline::translate_input_rate(VertexInputRate rate) {
+    switch (rate) {
+        case VertexInputRate::Vertex:
+            return VK_VERTEX_INPUT_RATE_VERTEX;
+        case VertexInputRate::Instance:
+            return VK_VERTEX_INPUT_RATE_INSTANCE;
+    }
+    assert(false);
+    return VK_VERTEX_INPUT_RATE_VERTEX;
+}
+
 VkBlendOp VulkanPipeline::translate_blend_op(BlendOperation op) {
     switch (op) {
         case BlendOperation::ADD:
@@ -2,6 +2,8 @@
 #include <giygas/Pipeline.hpp>
 #include <giygas/PipelineCreateParameters.hpp>
 #include <vulkan/vulkan.h>
+#include <memory>
+#include "VulkanPipelineStateCache.hpp"
 
 namespace giygas {
 
@@ -10,11 +12,9 @@ namespace giygas {
     class VulkanPipeline final : public Pipeline {
 
         VulkanRenderer *_renderer;
-        VkPipelineLayout _layout;
-        VkPipeline _handle;
-        VkDescriptorSetLayout _descriptor_set_layout;
-        PushConstantsRange _vertex_push_constants_range;
-        PushConstantsRange _fragment_push_constants_range;
+        std::shared_ptr<VulkanPipelineState> _state;
+
+        void create_state(const PipelineCreateParameters &params, VulkanPipelineState &state) const;
 
         static VkShaderStageFlagBits shader_type_to_stage_flags(ShaderType type);
 
@@ -24,6 +24,7 @@ namespace giygas {
         );
 
         static VkFormat get_attrib_format(size_t component_count);
+        static VkVertexInputRate translate_input_rate(VertexInputRate rate);
         static VkBlendOp translate_blend_op(BlendOperation op);
         static VkBlendFactor translate_blend_factor(BlendFactor factor);
 
@@ -33,7 +34,7 @@ namespace giygas {
         VulkanPipeline &operator=(const VulkanPipeline &) = delete;
         VulkanPipeline(VulkanPipeline &&) = delete;
         VulkanPipeline &operator=(VulkanPipeline &&) = delete;
-        ~VulkanPipeline() override;
+        ~VulkanPipeline() override = default;
 
         //
         // Pipeline implementation
@@ -0,0 +1,186 @@
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include "VulkanPipelineCache.hpp"
+
+using namespace giygas;
+using namespace std;
+
+static const char file_magic[8] = { 'G', 'I', 'Y', 'G', 'A', 'S', 'P', 'C' };
+static const uint32_t file_version = 1;
+
+// Written ahead of the driver's own cache data, which does not include the driver version.
+class PipelineCacheFileHeader {
+public:
+    char magic[8];
+    uint32_t version;
+    uint32_t vendor_id;
+    uint32_t device_id;
+    uint32_t driver_version;
+    uint8_t pipeline_cache_uuid[VK_UUID_SIZE];
+    uint64_t data_size;
+};
+
+// Size of the header at the start of the driver's cache data, for VK_PIPELINE_CACHE_HEADER_VERSION_ONE.
+static const size_t vulkan_header_size = 16 + VK_UUID_SIZE;
+
+static uint32_t read_uint32(const uint8_t *data) {
+    uint32_t value;
+    memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+VulkanPipelineCache::~VulkanPipelineCache() {
+    destroy();
+}
+
+void VulkanPipelineCache::create(
+    VkDevice device,
+    const VkPhysicalDeviceProperties &device_properties,
+    const char *path
+) {
+    _device = device;
+    _device_properties = device_properties;
+    _path = path == nullptr ? string() : string(path);
+
+    vector<uint8_t> file;
+    size_t data_offset = 0;
+    size_t data_size = 0;
+    if (!_path.empty()) {
+        file = read_file(_path);
+        if (!read_file_header(file.data(), file.size(), device_properties, data_offset, data_size)) {
+            data_size = 0;
+        }
+    }
+
+    VkPipelineCacheCreateInfo create_info = {};
+    create_info.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    create_info.initialDataSize = data_size;
+    create_info.pInitialData = data_size > 0 ? file.data() + data_offset : nullptr;
+    if (vkCreatePipelineCache(device, &create_info, nullptr, &_handle) != VK_SUCCESS && data_size > 0) {
+        // Start over with an empty cache.
+        create_info.initialDataSize = 0;
+        create_info.pInitialData = nullptr;
+        vkCreatePipelineCache(device, &create_info, nullptr, &_handle);
+    }
+}
+
+void VulkanPipelineCache::destroy() {
+    if (_handle == VK_NULL_HANDLE) {
+        return;
+    }
+    vkDestroyPipelineCache(_device, _handle, nullptr);
+    _handle = VK_NULL_HANDLE;
+}
+
+bool VulkanPipelineCache::save() const {
+    if (_handle == VK_NULL_HANDLE || _path.empty()) {
+        return false;
+    }
+
+    size_t size = 0;
+    if (vkGetPipelineCacheData(_device, _handle, &size, nullptr) != VK_SUCCESS) {
+        return false;
+    }
+    vector<uint8_t> data(size);
+    if (vkGetPipelineCacheData(_device, _handle, &size, data.data()) != VK_SUCCESS) {
+        return false;
+    }
+    vector<uint8_t> file = make_file(_device_properties, data.data(), size);
+
+    // Write next to the file and move it in place, so an interrupted write does not leave a damaged cache behind.
+    string temporary_path = _path + ".tmp";
+    {
+        ofstream stream(temporary_path, ofstream::binary | ofstream::trunc);
+        stream.write(reinterpret_cast<const char *>(file.data()), static_cast<streamsize>(file.size()));
+        if (!stream) {
+            return false;
+        }
+    }
+    remove(_path.c_str());
+    return rename(temporary_path.c_str(), _path.c_str()) == 0;
+}
+
+VkPipelineCache VulkanPipelineCache::handle() const {
+    return _handle;
+}
+
+vector<uint8_t> VulkanPipelineCache::read_file(const string &path) {
+    ifstream stream(path, ifstream::binary | ifstream::ate);
+    if (!stream) {
+        return vector<uint8_t>();
+    }
+    streamoff size = stream.tellg();
+    if (size <= 0) {
+        return vector<uint8_t>();
+    }
+    vector<uint8_t> file(static_cast<size_t>(size));
+    stream.seekg(0);
+    if (!stream.read(reinterpret_cast<char *>(file.data()), size)) {
+        return vector<uint8_t>();
+    }
+    return file;
+}
+
+vector<uint8_t> VulkanPipelineCache::make_file(
+    const VkPhysicalDeviceProperties &device_properties,
+    const uint8_t *data,
+    size_t size
+) {
+    PipelineCacheFileHeader header = {};
+    memcpy(header.magic, file_magic, sizeof(header.magic));
+    header.version = file_version;
+    header.vendor_id = device_properties.vendorID;
+    header.device_id = device_properties.deviceID;
+    header.driver_version = device_properties.driverVersion;
+    memcpy(header.pipeline_cache_uuid, device_properties.pipelineCacheUUID, VK_UUID_SIZE);
+    header.data_size = size;
+
+    vector<uint8_t> file(sizeof(header) + size);
+    memcpy(file.data(), &header, sizeof(header));
+    if (size > 0) {
+        memcpy(file.data() + sizeof(header), data, size);
+    }
+    return file;
+}
+
+bool VulkanPipelineCache::read_file_header(
+    const uint8_t *file,
+    size_t size,
+    const VkPhysicalDeviceProperties &device_properties,
+    size_t &data_offset,
+    size_t &data_size
+) {
+    PipelineCacheFileHeader header;
+    if (size < sizeof(header)) {
+        return false;
+    }
+    memcpy(&header, file, sizeof(header));
+    if (memcmp(header.magic, file_magic, sizeof(header.magic)) != 0
+        || header.version != file_version
+        || header.vendor_id != device_properties.vendorID
+        || header.device_id != device_properties.deviceID
+        || header.driver_version != device_properties.driverVersion
+        || memcmp(header.pipeline_cache_uuid, device_properties.pipelineCacheUUID, VK_UUID_SIZE) != 0
+        || header.data_size != size - sizeof(header)
+    ) {
+        return false;
+    }
+
+    // The driver's own header must agree as well.
+    const uint8_t *data = file + sizeof(header);
+    if (header.data_size < vulkan_header_size
+        || read_uint32(data) < vulkan_header_size
+        || read_uint32(data) > header.data_size
+        || read_uint32(data + 4) != VK_PIPELINE_CACHE_HEADER_VERSION_ONE
+        || read_uint32(data + 8) != device_properties.vendorID
+        || read_uint32(data + 12) != device_properties.deviceID
+        || memcmp(data + 16, device_properties.pipelineCacheUUID, VK_UUID_SIZE) != 0
+    ) {
+        return false;
+    }
+
+    data_offset = sizeof(header);
+    data_size = static_cast<size_t>(header.data_size);
+    return true;
+}
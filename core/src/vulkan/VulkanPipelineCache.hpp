@@ -0,0 +1,58 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace giygas {
+
+    // The renderer's VkPipelineCache, persisted to a file between runs so pipelines compiled once are not compiled
+    // again at the next launch. Cache data is only handed to the driver when it was written by the same device and
+    // driver version, since some drivers do not cope well with data from another driver.
+    class VulkanPipelineCache final {
+
+        VkDevice _device = VK_NULL_HANDLE;
+        VkPipelineCache _handle = VK_NULL_HANDLE;
+        VkPhysicalDeviceProperties _device_properties = {};
+        std::string _path;
+
+        static std::vector<uint8_t> read_file(const std::string &path);
+
+    public:
+        VulkanPipelineCache() = default;
+        VulkanPipelineCache(const VulkanPipelineCache &) = delete;
+        VulkanPipelineCache &operator=(const VulkanPipelineCache &) = delete;
+        VulkanPipelineCache(VulkanPipelineCache &&) noexcept = delete;
+        VulkanPipelineCache &operator=(VulkanPipelineCache &&) noexcept = delete;
+        ~VulkanPipelineCache();
+
+        // Creates the cache, seeded from the file at path when it holds compatible data. A null path creates a cache
+        // which only lives as long as the renderer.
+        void create(VkDevice device, const VkPhysicalDeviceProperties &device_properties, const char *path);
+        void destroy();
+
+        // Writes the cache to its file. Returns false when there is no file or writing failed.
+        bool save() const;
+
+        VkPipelineCache handle() const;
+
+        // Prepends the header identifying the device and driver to cache data.
+        static std::vector<uint8_t> make_file(
+            const VkPhysicalDeviceProperties &device_properties,
+            const uint8_t *data,
+            size_t size
+        );
+
+        // Checks a cache file against the device it is about to be loaded on, and finds the Vulkan cache data within
+        // it. Returns false when the file is damaged, or was written by another device or driver version.
+        static bool read_file_header(
+            const uint8_t *file,
+            size_t size,
+            const VkPhysicalDeviceProperties &device_properties,
+            size_t &data_offset,
+            size_t &data_size
+        );
+    };
+
+}
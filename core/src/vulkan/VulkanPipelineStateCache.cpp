@@ -0,0 +1,167 @@
+#include "VulkanPipelineStateCache.hpp"
+#include "VulkanRenderer.hpp"
+#include "VulkanShader.hpp"
+#include "VulkanRenderPass.hpp"
+#include "VulkanDescriptorSet.hpp"
+#include "../hash.hpp"
+
+using namespace giygas;
+using namespace std;
+
+class PipelineStateSafeDeletable final : public SwapchainSafeDeleteable {
+
+    VkPipeline _pipeline;
+
+public:
+
+    explicit PipelineStateSafeDeletable(VkPipeline pipeline) {
+        _pipeline = pipeline;
+    }
+
+    void delete_resources(VulkanRenderer &renderer) override {
+        vkDestroyPipeline(renderer.device(), _pipeline, nullptr);
+    }
+
+};
+
+//
+// VulkanPipelineKey implementation
+//
+
+VulkanPipelineKey::VulkanPipelineKey() {
+    _hash = 0;
+}
+
+VulkanPipelineKey::VulkanPipelineKey(const PipelineCreateParameters &params) {
+    _words.push_back(params.blend.enabled ? 1 : 0);
+    _words.push_back(static_cast<uint64_t>(params.blend.mask_channels));
+    _words.push_back(static_cast<uint64_t>(params.blend.src_color_factor));
+    _words.push_back(static_cast<uint64_t>(params.blend.dst_color_factor));
+    _words.push_back(static_cast<uint64_t>(params.blend.color_op));
+    _words.push_back(static_cast<uint64_t>(params.blend.src_alpha_factor));
+    _words.push_back(static_cast<uint64_t>(params.blend.dst_alpha_factor));
+    _words.push_back(static_cast<uint64_t>(params.blend.alpha_op));
+
+    _words.push_back(params.vertex_buffer_layout_count);
+    for (size_t i = 0; i < params.vertex_buffer_layout_count; ++i) {
+        const VertexAttributeLayout &layout = params.vertex_buffer_layouts[i];
+        _words.push_back(layout.stride);
+        _words.push_back(static_cast<uint64_t>(layout.input_rate));
+        _words.push_back(layout.attribute_count);
+        for (size_t j = 0; j < layout.attribute_count; ++j) {
+            const VertexAttribute &attribute = layout.attributes[j];
+            _words.push_back(attribute.component_count);
+            _words.push_back(attribute.component_size);
+            _words.push_back(attribute.offset);
+        }
+    }
+
+    _words.push_back(params.shader_count);
+    for (size_t i = 0; i < params.shader_count; ++i) {
+        const auto *shader_impl = static_cast<const VulkanShader *>(params.shaders[i]);
+        _words.push_back(shader_impl->id());
+        _words.push_back(static_cast<uint64_t>(shader_impl->shader_type()));
+    }
+
+    const auto *pass_impl = static_cast<const VulkanRenderPass *>(params.pass);
+    _words.push_back(pass_impl->id());
+
+    _words.push_back(params.vertex_push_constants.size);
+    _words.push_back(params.vertex_push_constants.offset);
+    _words.push_back(params.fragment_push_constants.size);
+    _words.push_back(params.fragment_push_constants.offset);
+
+    uint64_t descriptor_set_layout_id = 0;
+    if (params.descriptor_set != nullptr) {
+        descriptor_set_layout_id = static_cast<const VulkanDescriptorSet *>(params.descriptor_set)->layout()->id;
+    }
+    _words.push_back(descriptor_set_layout_id);
+
+    uint64_t hash = 0;
+    for (uint64_t word : _words) {
+        hash = mix_bits(hash ^ word);
+    }
+    _hash = static_cast<size_t>(hash);
+}
+
+size_t VulkanPipelineKey::hash() const {
+    return _hash;
+}
+
+bool VulkanPipelineKey::operator==(const VulkanPipelineKey &other) const {
+    return _hash == other._hash && _words == other._words;
+}
+
+//
+// VulkanPipelineState implementation
+//
+
+VulkanPipelineState::VulkanPipelineState(VulkanRenderer *renderer) {
+    _renderer = renderer;
+    _cache = nullptr;
+    handle = VK_NULL_HANDLE;
+    vertex_push_constants_range = {};
+    fragment_push_constants_range = {};
+}
+
+VulkanPipelineState::~VulkanPipelineState() {
+    if (_cache != nullptr) {
+        _cache->remove(_key);
+    }
+    if (handle != VK_NULL_HANDLE) {
+        _renderer->delete_when_safe(unique_ptr<SwapchainSafeDeleteable>(new PipelineStateSafeDeletable(handle)));
+    }
+}
+
+void VulkanPipelineState::set_cache_entry(VulkanPipelineStateCache *cache, const VulkanPipelineKey &key) {
+    _cache = cache;
+    _key = key;
+}
+
+void VulkanPipelineState::destroy_unused() {
+    vkDestroyPipeline(_renderer->device(), handle, nullptr);
+    handle = VK_NULL_HANDLE;
+}
+
+//
+// VulkanPipelineStateCache implementation
+//
+
+shared_ptr<VulkanPipelineState> VulkanPipelineStateCache::find(const VulkanPipelineKey &key) {
+    lock_guard<mutex> _(_mutex);
+    auto found = _states.find(key);
+    if (found == _states.end()) {
+        return nullptr;
+    }
+    return found->second.lock();
+}
+
+shared_ptr<VulkanPipelineState> VulkanPipelineStateCache::add(
+    const VulkanPipelineKey &key,
+    shared_ptr<VulkanPipelineState> state
+) {
+    shared_ptr<VulkanPipelineState> existing;
+    {
+        lock_guard<mutex> _(_mutex);
+        weak_ptr<VulkanPipelineState> &entry = _states[key];
+        existing = entry.lock();
+        if (existing == nullptr) {
+            entry = state;
+            state->set_cache_entry(this, key);
+            return state;
+        }
+    }
+
+    // The state may be on a worker thread creating pipelines, where it can not be handed to delete_when_safe().
+    // Nothing has used it yet, so it can go right away.
+    state->destroy_unused();
+    return existing;
+}
+
+void VulkanPipelineStateCache::remove(const VulkanPipelineKey &key) {
+    lock_guard<mutex> _(_mutex);
+    auto found = _states.find(key);
+    if (found != _states.end() && found->second.expired()) {
+        _states.erase(found);
+    }
+}
@@ -0,0 +1,95 @@
+#pragma once
+#include <giygas/PipelineCreateParameters.hpp>
+#include <vulkan/vulkan.h>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "VulkanLayoutCache.hpp"
+
+namespace giygas {
+
+    class VulkanRenderer;
+    class VulkanPipelineStateCache;
+
+    // Everything pipeline creation reads from PipelineCreateParameters, flattened so that equal parameters give equal
+    // keys. Vertex layouts are compared by value, and shaders, the render pass and the descriptor set layout by id.
+    class VulkanPipelineKey {
+
+        std::vector<uint64_t> _words;
+        size_t _hash;
+
+    public:
+        VulkanPipelineKey();
+        explicit VulkanPipelineKey(const PipelineCreateParameters &params);
+
+        size_t hash() const;
+        bool operator==(const VulkanPipelineKey &other) const;
+    };
+
+    class VulkanPipelineKeyHash {
+    public:
+        size_t operator()(const VulkanPipelineKey &key) const {
+            return key.hash();
+        }
+    };
+
+    // The backend objects of a pipeline, shared by every VulkanPipeline created with the same parameters. The pipeline
+    // is deleted once the last VulkanPipeline using it is destroyed and no frame in flight uses it anymore.
+    class VulkanPipelineState final {
+
+        VulkanRenderer *_renderer;
+        VulkanPipelineStateCache *_cache;
+        VulkanPipelineKey _key;
+
+    public:
+        VkPipeline handle;
+        std::shared_ptr<const VulkanPipelineLayout> layout;
+        PushConstantsRange vertex_push_constants_range;
+        PushConstantsRange fragment_push_constants_range;
+
+        explicit VulkanPipelineState(VulkanRenderer *renderer);
+        VulkanPipelineState(const VulkanPipelineState &) = delete;
+        VulkanPipelineState &operator=(const VulkanPipelineState &) = delete;
+        VulkanPipelineState(VulkanPipelineState &&) noexcept = delete;
+        VulkanPipelineState &operator=(VulkanPipelineState &&) noexcept = delete;
+        ~VulkanPipelineState();
+
+        // Called by the cache when the state is added to it, so the state can remove itself once destroyed.
+        void set_cache_entry(VulkanPipelineStateCache *cache, const VulkanPipelineKey &key);
+
+        // Destroys the objects right away, for states which were never used in a frame.
+        void destroy_unused();
+    };
+
+    // Pipeline states by key, so identical pipelines share one VkPipeline. The cache only holds
+    // weak references; states live as long as the pipelines using them. May be used from any thread.
+    class VulkanPipelineStateCache final {
+
+        std::mutex _mutex;
+        std::unordered_map<VulkanPipelineKey, std::weak_ptr<VulkanPipelineState>, VulkanPipelineKeyHash> _states;
+
+    public:
+        VulkanPipelineStateCache() = default;
+        VulkanPipelineStateCache(const VulkanPipelineStateCache &) = delete;
+        VulkanPipelineStateCache &operator=(const VulkanPipelineStateCache &) = delete;
+        VulkanPipelineStateCache(VulkanPipelineStateCache &&) noexcept = delete;
+        VulkanPipelineStateCache &operator=(VulkanPipelineStateCache &&) noexcept = delete;
+
+        // Returns the state created for the key, or null when there is none.
+        std::shared_ptr<VulkanPipelineState> find(const VulkanPipelineKey &key);
+
+        // Adds a newly created state. When another thread added a state for the same key in the meantime, the given
+        // state is destroyed and the existing one returned instead.
+        std::shared_ptr<VulkanPipelineState> add(
+            const VulkanPipelineKey &key,
+            std::shared_ptr<VulkanPipelineState> state
+        );
+
+        // Removes the key, unless it has been taken over by a live state.
+        void remove(const VulkanPipelineKey &key);
+    };
+
+}
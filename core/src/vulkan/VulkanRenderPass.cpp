@@ -26,6 +26,7 @@ public:
 VulkanRenderPass::VulkanRenderPass(VulkanRenderer *renderer) {
     _renderer = renderer;
     _handle = VK_NULL_HANDLE;
+    _id = 0;
 }
 
 VulkanRenderPass::~VulkanRenderPass() {
@@ -75,7 +76,7 @@ void VulkanRenderPass::create(const RenderPassCreateParameters &params) {
         _purposes[i] = attachment.purpose;
         VkAttachmentDescription &description = attachment_descriptions[i];
         const auto *target = static_cast<const VulkanRenderTarget *>(attachment.target->rendertarget_impl());
-        set_description_from_attachmnent_params(description, target);
+        set_description_from_attachmnent_params(description, target, _renderer->is_headless());
 
         VkAttachmentReference *ref;
         if (attachment.purpose == AttachmentPurpose::Color) {
@@ -113,6 +114,7 @@ void VulkanRenderPass::create(const RenderPassCreateParameters &params) {
     renderpass_create_info.pDependencies = &subpass_dependency;
 
     vkCreateRenderPass(_renderer->device(), &renderpass_create_info, nullptr, &_handle);
+    _id = _renderer->make_object_id();
 }
 
 bool VulkanRenderPass::is_valid() const {
@@ -123,6 +125,10 @@ VkRenderPass VulkanRenderPass::handle() const {
     return _handle;
 }
 
+uint64_t VulkanRenderPass::id() const {
+    return _id;
+}
+
 uint32_t VulkanRenderPass::attachment_count() const {
     return _attachment_count;
 }
@@ -133,7 +139,8 @@ const AttachmentPurpose* VulkanRenderPass::attachment_purposes() const {
 
 void VulkanRenderPass::set_description_from_attachmnent_params(
     VkAttachmentDescription &description,
-    const VulkanRenderTarget *target
+    const VulkanRenderTarget *target,
+    bool is_headless
 ) {
     description.format = static_cast<VkFormat>(target->api_format());
     description.samples = VK_SAMPLE_COUNT_1_BIT;
@@ -142,7 +149,10 @@ void VulkanRenderPass::set_description_from_attachmnent_params(
     description.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
     description.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
     description.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    if (target->is_swapchain()) {
+    if (target->is_swapchain() && is_headless) {
+        // Offscreen swapchain images are never presented, leave them ready to be read back instead.
+        description.finalLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    } else if (target->is_swapchain()) {
         description.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
     } else {
         description.finalLayout = target->layout();
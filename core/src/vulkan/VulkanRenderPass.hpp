@@ -13,12 +13,14 @@ namespace giygas {
 
         VulkanRenderer *_renderer;
         VkRenderPass _handle;
+        uint64_t _id;
         uint32_t _attachment_count;
         unique_ptr<AttachmentPurpose[]> _purposes;
 
         static void set_description_from_attachmnent_params(
             VkAttachmentDescription &description,
-            const VulkanRenderTarget *target
+            const VulkanRenderTarget *target,
+            bool is_headless
         );
 
     public:
@@ -41,6 +43,9 @@ namespace giygas {
 
         VkRenderPass handle() const;
 
+        // Identifies the render pass for as long as the renderer lives. 0 until created.
+        uint64_t id() const;
+
     };
 
 }
@@ -1,58 +1,107 @@
+#include <algorithm>
 #include <cassert>
+#include <cstring>
 #include <limits>
+#include <thread>
 #include "VulkanRenderer.hpp"
 #include "VulkanPipeline.hpp"
 #include "VulkanVertexBuffer.hpp"
 #include "VulkanIndexBuffer.hpp"
+#include "VulkanIndirectBuffer.hpp"
 #include "VulkanShader.hpp"
 #include "VulkanTexture.hpp"
 #include "VulkanFramebuffer.hpp"
 #include "VulkanCommandBuffer.hpp"
 #include "VulkanUniformBuffer.hpp"
+#include "VulkanStreamBuffer.hpp"
 #include "VulkanSampler.hpp"
 #include "VulkanDescriptorPool.hpp"
 #include "VulkanDescriptorSet.hpp"
 #include "VulkanRenderPass.hpp"
+#include "../draw_sorting.hpp"
 #include "VulkanVertexBufferImpl.cpp"
 #include <giygas/validation/submission_validation.hpp>
+#include <giygas/validation/renderer_validation.hpp>
 
 using namespace giygas;
 using namespace std;
 
+static const VkDeviceSize initial_staging_capacity = 8 * 1024 * 1024;
+
 VulkanRenderer::VulkanRenderer(VulkanContext *context) {
     _context = context;
+    _completed_frame_serial = 0;
+    _next_object_id = 1;
+    _layouts.create(this);
 }
 
 VulkanRenderer::~VulkanRenderer() {
+    // Finish textures and pipelines still being created in the background.
+    _background_tasks.reset();
+    _pipeline_tasks.reset();
+    _pipeline_workers.reset();
+
     // call the destroy method here, as it will add safe deletables to the queue, which we process below.
     finish_enqueued_command_buffers();
 
-    for (uint32_t i = 0, ilen = _swapchain.image_count(); i < ilen; ++i) {
-        vkDestroyFence(_device, _fences_by_submission[i], nullptr);
-        vkDestroySemaphore(_device, _swapchain_image_available_semaphores[i], nullptr);
-        delete_resources_for_image_index(i);
-        _command_buffers_by_submission[i].destroy();
-        _command_pools_by_submission[i].destroy();
+    // Uploads flushed after the last frame are not covered by its serial.
+    if (_device != VK_NULL_HANDLE) {
+        vkDeviceWaitIdle(_device);
+    }
+
+    // With the device idle, nothing queued for deletion is in use anymore, including resources queued for the next
+    // submission.
+    _completed_frame_serial = numeric_limits<uint64_t>::max();
+    delete_completed_resources();
+
+    for (uint32_t i = 0; i < _frame_count; ++i) {
+        vkDestroyFence(_device, _fences_by_frame[i], nullptr);
+        vkDestroySemaphore(_device, _image_available_semaphores_by_frame[i], nullptr);
+        _command_buffers_by_frame[i].destroy();
+        _command_pools_by_frame[i].destroy();
+        for (uint32_t j = 0; j < _recording_thread_count; ++j) {
+            _recording_command_pools[i * _recording_thread_count + j].destroy();
+        }
     }
+    _recording_workers.reset();
 
-    _copy_command_pool.destroy();
+    if (_render_finished_semaphores_by_image != nullptr) {
+        for (uint32_t i = 0, ilen = swapchain_image_count(); i < ilen; ++i) {
+            vkDestroySemaphore(_device, _render_finished_semaphores_by_image[i], nullptr);
+        }
+    }
+    vkDestroySemaphore(_device, _frame_timeline_semaphore, nullptr);
+
+    _upload_context.destroy();
+    _pipeline_cache.save();
+    _pipeline_cache.destroy();
     _swapchain.destroy();
+    _offscreen_swapchain.destroy();
+    _memory_allocator.destroy();
 
     vkDestroyDevice(_device, nullptr);
-    vkDestroySurfaceKHR(_instance, _surface, nullptr);
+    if (_surface != VK_NULL_HANDLE) {
+        vkDestroySurfaceKHR(_instance, _surface, nullptr);
+    }
     vkDestroyInstance(_instance, nullptr);
 }
 
-void VulkanRenderer::initialize() {
+void VulkanRenderer::initialize(const RendererInitParameters &params) {
+    assert(validation::validate_renderer_initialize(params));
+
     if (!_context->initialize_for_vulkan()) {
         return;
     }
 
-    if (create_instance(_context, _instance) != VK_SUCCESS) {
+    if (create_instance(_context, _instance, _has_physical_device_properties2) != VK_SUCCESS) {
         return;
     }
 
-    if (_context->create_surface(_instance, &_surface) != VK_SUCCESS) {
+    _is_headless = _context->is_headless();
+    _is_low_latency = params.low_latency;
+    _sort_draws = params.sort_draws;
+
+    if (!_is_headless && _context->create_surface(_instance, &_surface) != VK_SUCCESS) {
         return;
     }
 
@@ -68,85 +117,144 @@ void VulkanRenderer::initialize() {
         return;
     }
 
+#ifdef VK_KHR_timeline_semaphore
+    _has_timeline_semaphores = _has_physical_device_properties2 && physical_device_has_extension(
+        physical_device,
+        VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME
+    );
+#endif
+
+    // Optional features are enabled whenever the device supports them.
+    VkPhysicalDeviceFeatures supported_features = {};
+    vkGetPhysicalDeviceFeatures(physical_device, &supported_features);
+    _enabled_features = {};
+    _enabled_features.multiDrawIndirect = supported_features.multiDrawIndirect;
+    _enabled_features.drawIndirectFirstInstance = supported_features.drawIndirectFirstInstance;
+
+    VkPhysicalDeviceProperties physical_device_properties = {};
+    vkGetPhysicalDeviceProperties(physical_device, &physical_device_properties);
+    _limits = physical_device_properties.limits;
+
     if (create_logical_device(
         physical_device,
         _queue_family_indices,
+        _is_headless,
+        _has_timeline_semaphores,
+        _enabled_features,
         _device
     ) != VK_SUCCESS) {
         return;
     }
 
-    VkSurfaceFormatKHR swapchain_format = choose_surface_format(swapchain_info);
-    VkPresentModeKHR present_mode = choose_present_mode(swapchain_info);
-    VkExtent2D swapchain_extent = choose_swap_extent(swapchain_info);
+    _pipeline_cache.create(_device, physical_device_properties, params.pipeline_cache_path);
 
-    _swapchain.create(
-        this,
-        _surface,
-        swapchain_format,
-        present_mode,
-        swapchain_extent,
-        swapchain_info
-    );
+    if (_has_timeline_semaphores && create_frame_timeline_semaphore() != VK_SUCCESS) {
+        // Fall back to fences.
+        _has_timeline_semaphores = false;
+    }
 
     vkGetPhysicalDeviceMemoryProperties(physical_device, &_memory_properties);
+    _memory_allocator.create(_device, _memory_properties);
+    _is_unified_memory = has_unified_memory(_memory_properties);
     vkGetDeviceQueue(_device, _queue_family_indices.graphics_family, 0, &_graphics_queue);
     vkGetDeviceQueue(_device, _queue_family_indices.present_family, 0, &_present_queue);
+    if (_queue_family_indices.has_transfer_family()) {
+        vkGetDeviceQueue(_device, _queue_family_indices.transfer_family, 0, &_transfer_queue);
+    }
 
-    uint32_t image_count = _swapchain.image_count();
-    _swapchain_image_available_semaphores = unique_ptr<VkSemaphore[]>(new VkSemaphore[image_count]);
-    _fences_by_submission = unique_ptr<VkFence[]>(new VkFence[image_count]);
-    _command_pools_by_submission = unique_ptr<VulkanCommandPool[]>(new VulkanCommandPool[image_count]);
-    _command_buffers_by_submission = unique_ptr<VulkanCommandBuffer[]>(new VulkanCommandBuffer[image_count]);
-    _command_buffer_handles_by_submission = unique_ptr<VkCommandBuffer[]>(new VkCommandBuffer[image_count]);
-    _image_indices_by_submission = unique_ptr<uint32_t[]>(new uint32_t[image_count]);
+    if (_is_headless) {
+        _offscreen_swapchain.create(
+            this,
+            VK_FORMAT_B8G8R8A8_UNORM,
+            _context->offscreen_extent(),
+            _context->offscreen_image_count()
+        );
+    } else {
+        VkSurfaceFormatKHR swapchain_format = choose_surface_format(swapchain_info);
+        VkExtent2D swapchain_extent = choose_swap_extent(swapchain_info);
+        _present_mode = choose_present_mode(swapchain_info, params.present_mode);
+
+        _swapchain.create(
+            this,
+            _surface,
+            swapchain_format,
+            _present_mode,
+            swapchain_extent,
+            swapchain_info
+        );
+    }
+
+    uint32_t image_count = swapchain_image_count();
+    uint32_t frame_count = params.frames_in_flight;
+
+    _image_available_semaphores_by_frame = unique_ptr<VkSemaphore[]>(new VkSemaphore[frame_count]);
+    _fences_by_frame = unique_ptr<VkFence[]>(new VkFence[frame_count]);
+    _command_pools_by_frame = unique_ptr<VulkanCommandPool[]>(new VulkanCommandPool[frame_count]);
+    _command_buffers_by_frame = unique_ptr<VulkanCommandBuffer[]>(new VulkanCommandBuffer[frame_count]);
+    _command_buffer_handles_by_frame = unique_ptr<VkCommandBuffer[]>(new VkCommandBuffer[frame_count]);
+    _serials_by_frame = unique_ptr<uint64_t[]>(new uint64_t[frame_count]);
+    _frame_count = frame_count;
+    _frame_index = 0;
+
+    uint32_t recording_thread_count = params.recording_thread_count;
+    _recording_thread_count = recording_thread_count;
+    _recording_command_pools = unique_ptr<VulkanCommandPool[]>(
+        new VulkanCommandPool[frame_count * recording_thread_count]
+    );
+    _recording_arenas = unique_ptr<LinearArena[]>(new LinearArena[frame_count * recording_thread_count]);
+    if (recording_thread_count > 1) {
+        _recording_workers = unique_ptr<WorkerPool>(new WorkerPool(recording_thread_count));
+    }
+    _is_frame_ready = true;
 
     //
-    // Create semaphores and other per submission resources
+    // Create semaphores and other per frame resources
     //
     VkSemaphoreCreateInfo semaphore_info = {};
     semaphore_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
 
-    for (uint32_t i = 0; i < image_count; ++i) {
-        vkCreateSemaphore(_device, &semaphore_info, nullptr, &_swapchain_image_available_semaphores[i]);
-        _command_pools_by_submission[i].create(this);
-        _command_buffers_by_submission[i].create(this, &_command_pools_by_submission[i]);
-        _command_buffer_handles_by_submission[i] = _command_buffers_by_submission[i].handle();
-        _image_indices_by_submission[i] = numeric_limits<uint32_t>::max();
-    }
-
-    //
-    // Create command buffer execution fences
-    //
-    VkFence fence;
+    // All fences start signalled, as there are no command buffers to wait on yet. Each fence is reset right before
+    // it is given to vkQueueSubmit.
     VkFenceCreateInfo fence_info = {};
     fence_info.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
     fence_info.flags = VK_FENCE_CREATE_SIGNALED_BIT;
 
-    // submit the first fences as signalled, as we don't actually have any command buffers to wait on, given that we
-    // just started the engine.
-    for (uint32_t i = 1; i < image_count; ++i) {
-        vkCreateFence(_device, &fence_info, nullptr, &fence);
-        _fences_by_submission[i] = fence;
+    for (uint32_t i = 0; i < frame_count; ++i) {
+        _image_available_semaphores_by_frame[i] = VK_NULL_HANDLE;
+        if (!_is_headless) {
+            vkCreateSemaphore(_device, &semaphore_info, nullptr, &_image_available_semaphores_by_frame[i]);
+        }
+        vkCreateFence(_device, &fence_info, nullptr, &_fences_by_frame[i]);
+        _command_pools_by_frame[i].create(this);
+        _command_buffers_by_frame[i].create(this, &_command_pools_by_frame[i]);
+        _command_buffer_handles_by_frame[i] = _command_buffers_by_frame[i].handle();
+        _command_buffers_by_frame[i].set_scratch_arenas(&_recording_arenas[i * recording_thread_count]);
+        if (_recording_workers != nullptr) {
+            VulkanCommandPool *recording_pools = &_recording_command_pools[i * recording_thread_count];
+            for (uint32_t j = 0; j < recording_thread_count; ++j) {
+                recording_pools[j].create(this);
+            }
+            _command_buffers_by_frame[i].set_recording_workers(_recording_workers.get(), recording_pools);
+        }
+        _serials_by_frame[i] = 0;
     }
 
-    // Submit the last fence as unsigned, as this is the first fence that will be given to vkQueueSubmit.
-    fence_info.flags = 0;
-    vkCreateFence(_device, &fence_info, nullptr, &fence);
-    _fences_by_submission[0] = fence;
-
-    // Fill up the submission indices
-    for (uint32_t i = image_count; i > 0; i--) {
-        _submissions.push(i - 1);
+    //
+    // Create per image resources
+    //
+    _render_finished_semaphores_by_image = unique_ptr<VkSemaphore[]>(new VkSemaphore[image_count]);
+    _serials_by_image = unique_ptr<uint64_t[]>(new uint64_t[image_count]);
+    for (uint32_t i = 0; i < image_count; ++i) {
+        _render_finished_semaphores_by_image[i] = VK_NULL_HANDLE;
+        if (!_is_headless) {
+            vkCreateSemaphore(_device, &semaphore_info, nullptr, &_render_finished_semaphores_by_image[i]);
+        }
+        _serials_by_image[i] = 0;
     }
 
-    _copy_command_pool.create(this);
-
-    // Create swapchain safe deletable lists for each submission
-    _safe_deletables_by_image_index = unique_ptr<vector<unique_ptr<SwapchainSafeDeleteable>>[]>(
-        new vector<unique_ptr<SwapchainSafeDeleteable>> [_swapchain.image_count()]
-    );
-
+    _upload_context.create(this, initial_staging_capacity);
+    _background_tasks = unique_ptr<TaskQueue>(new TaskQueue());
+    _pipeline_tasks = unique_ptr<TaskQueue>(new TaskQueue());
 }
 
 RendererType VulkanRenderer::renderer_type() const {
@@ -155,41 +263,73 @@ RendererType VulkanRenderer::renderer_type() const {
 
 VertexBuffer* VulkanRenderer::make_vertex_buffer(VertexBufferCreateFlags flags) {
     if (flags & VertexBufferCreateFlag_Writable) {
-        return new VulkanVertexBufferImpl<WritableVertexBuffer>(this);
+        auto *buffer = new VulkanVertexBufferImpl<WritableVertexBuffer>(this);
+        if (flags & VertexBufferCreateFlag_NoShadowCopy) {
+            buffer->buffer().disable_shadow_copy();
+        }
+        return buffer;
     } else {
         return new VulkanVertexBufferImpl<ReadOnlyVertexBuffer>(this);
     }
 }
 
 IndexBuffer<uint32_t>* VulkanRenderer::make_index_buffer_32(IndexBufferCreateFlags flags) {
-    if (flags & VertexBufferCreateFlag_Writable) {
-        return new VulkanIndexBuffer<uint32_t, uint32_t, WritableIndexBuffer>(this);
+    if (flags & IndexBufferCreateFlag_Writable) {
+        auto *buffer = new VulkanIndexBuffer<uint32_t, uint32_t, WritableIndexBuffer>(this);
+        if (flags & IndexBufferCreateFlag_NoShadowCopy) {
+            buffer->buffer().disable_shadow_copy();
+        }
+        return buffer;
     } else {
         return new VulkanIndexBuffer<uint32_t, uint32_t, ReadOnlyIndexBuffer>(this);
     }
 }
 
 IndexBuffer<uint16_t>* VulkanRenderer::make_index_buffer_16(IndexBufferCreateFlags flags) {
-    if (flags & VertexBufferCreateFlag_Writable) {
-        return new VulkanIndexBuffer<uint16_t, uint16_t, WritableIndexBuffer>(this);
+    if (flags & IndexBufferCreateFlag_Writable) {
+        auto *buffer = new VulkanIndexBuffer<uint16_t, uint16_t, WritableIndexBuffer>(this);
+        if (flags & IndexBufferCreateFlag_NoShadowCopy) {
+            buffer->buffer().disable_shadow_copy();
+        }
+        return buffer;
     } else {
         return new VulkanIndexBuffer<uint16_t, uint16_t, ReadOnlyIndexBuffer>(this);
     }
 }
 
 IndexBuffer<uint8_t>* VulkanRenderer::make_index_buffer_8(IndexBufferCreateFlags flags) {
-    if (flags & VertexBufferCreateFlag_Writable) {
-        return new VulkanIndexBuffer<uint8_t, uint16_t, WritableIndexBuffer>(this);
+    if (flags & IndexBufferCreateFlag_Writable) {
+        auto *buffer = new VulkanIndexBuffer<uint8_t, uint16_t, WritableIndexBuffer>(this);
+        if (flags & IndexBufferCreateFlag_NoShadowCopy) {
+            buffer->buffer().disable_shadow_copy();
+        }
+        return buffer;
     } else {
         return new VulkanIndexBuffer<uint8_t, uint16_t, ReadOnlyIndexBuffer>(this);
     }
 }
 
+IndirectBuffer* VulkanRenderer::make_indirect_buffer(IndirectBufferCreateFlags flags) {
+    if (flags & IndirectBufferCreateFlag_Writable) {
+        auto *buffer = new VulkanIndirectBufferImpl<WritableIndirectBuffer>(this, true);
+        if (flags & IndirectBufferCreateFlag_NoShadowCopy) {
+            buffer->buffer().disable_shadow_copy();
+        }
+        return buffer;
+    } else {
+        return new VulkanIndirectBufferImpl<ReadOnlyIndirectBuffer>(this, false);
+    }
+}
+
 
 UniformBuffer* VulkanRenderer::make_uniform_buffer() {
     return new VulkanUniformBuffer(this);
 }
 
+StreamBuffer* VulkanRenderer::make_stream_buffer(uint32_t capacity) {
+    return new VulkanStreamBuffer(this, capacity);
+}
+
 Shader* VulkanRenderer::make_shader() {
     return new VulkanShader(this);
 }
@@ -222,79 +362,325 @@ Pipeline *VulkanRenderer::make_pipeline() {
     return new VulkanPipeline(this);
 }
 
+void VulkanRenderer::create_pipelines(
+    const PipelineCreateParameters *params,
+    Pipeline *const *pipelines,
+    uint32_t count,
+    bool *is_valid
+) {
+    compile_pipelines(params, pipelines, count);
+    if (is_valid != nullptr) {
+        for (uint32_t i = 0; i < count; ++i) {
+            is_valid[i] = pipelines[i]->is_valid();
+        }
+    }
+}
+
+void VulkanRenderer::create_pipelines_async(
+    const PipelineCreateParameters *params,
+    Pipeline *const *pipelines,
+    uint32_t count,
+    PipelineBatchCallback callback
+) {
+    _pipeline_tasks->enqueue([this, params, pipelines, count, callback]() {
+        unique_ptr<bool[]> is_valid(new bool[count]);
+        create_pipelines(params, pipelines, count, is_valid.get());
+        if (callback) {
+            callback(is_valid.get(), count);
+        }
+    });
+}
+
+void VulkanRenderer::compile_pipelines(
+    const PipelineCreateParameters *params,
+    Pipeline *const *pipelines,
+    uint32_t count
+) {
+    assert(count == 0 || (params != nullptr && pipelines != nullptr));
+
+    // The pipeline cache is internally synchronized, so pipelines can be created through it from any thread.
+    lock_guard<mutex> _(_pipeline_workers_mutex);
+    if (_pipeline_workers == nullptr) {
+        _pipeline_workers = unique_ptr<WorkerPool>(new WorkerPool(max(thread::hardware_concurrency(), 1u)));
+    }
+    _pipeline_workers->parallel_for(count, [params, pipelines](uint32_t task_index, uint32_t) {
+        pipelines[task_index]->create(params[task_index]);
+    });
+}
+
 const RenderTarget *VulkanRenderer::swapchain() const {
+    if (_is_headless) {
+        return _offscreen_swapchain.rendertarget();
+    }
     return _swapchain.rendertarget();
 }
 
-uint32_t VulkanRenderer::next_submission_index() const {
-    return _submissions.back();
+uint32_t VulkanRenderer::current_frame_index() const {
+    return _frame_index;
+}
+
+bool VulkanRenderer::is_frame_ready() const {
+    return _is_frame_ready;
+}
+
+uint64_t VulkanRenderer::next_submission_serial() const {
+    return _is_frame_ready ? _frame_serial : _frame_serial + 1;
+}
+
+uint64_t VulkanRenderer::completed_frame_serial() const {
+    return _completed_frame_serial;
+}
+
+uint32_t VulkanRenderer::frames_in_flight() const {
+    return _frame_count;
+}
+
+const SubmissionStats &VulkanRenderer::last_submission_stats() const {
+    return _last_submission_stats;
+}
+
+bool VulkanRenderer::save_pipeline_cache() {
+    return _pipeline_cache.save();
+}
+
+uint32_t VulkanRenderer::recording_thread_count() const {
+    return _recording_thread_count;
+}
+
+VkPresentModeKHR VulkanRenderer::present_mode() const {
+    return _present_mode;
 }
 
 uint32_t VulkanRenderer::swapchain_image_count() const {
+    if (_is_headless) {
+        return _offscreen_swapchain.image_count();
+    }
     return _swapchain.image_count();
 }
 
-void VulkanRenderer::submit(const PassSubmissionInfo *passes, uint32_t pass_count) {
-    assert(validation::validate_submission_passes(passes, pass_count, RendererType::Vulkan));
+bool VulkanRenderer::is_headless() const {
+    return _is_headless;
+}
 
-    uint32_t submission = _submissions.back();
+bool VulkanRenderer::is_unified_memory() const {
+    return _is_unified_memory;
+}
 
-    uint32_t next_image = _swapchain.image_count(); // smoking gun default value in case of Vulkan misuse or bugs.
-    VkResult acquire_result = vkAcquireNextImageKHR(_device, _swapchain.handle(), numeric_limits<uint64_t>::max(), _swapchain_image_available_semaphores[submission], nullptr, &next_image);
-    if (acquire_result != VK_SUCCESS && acquire_result != VK_TIMEOUT && acquire_result != VK_NOT_READY) {
-        assert(!"Not Implemented: Need to handle non successful image acquisition.");
+void VulkanRenderer::submit(const PassSubmissionInfo *passes, uint32_t pass_count) {
+    // Without multiDrawIndirect, indirect draws are split into one draw per command, so there is no limit.
+    assert(validation::validate_submission_passes(
+        passes,
+        pass_count,
+        RendererType::Vulkan,
+        _enabled_features.multiDrawIndirect ? _limits.maxDrawIndirectCount : numeric_limits<uint32_t>::max()
+    ));
+
+    // Nothing to do here if the caller already waited before running game logic.
+    wait_for_next_frame();
+
+    uint32_t frame = _frame_index;
+    uint64_t serial = _frame_serial;
+
+    uint32_t next_image = swapchain_image_count(); // smoking gun default value in case of Vulkan misuse or bugs.
+    if (_is_headless) {
+        next_image = _next_offscreen_image;
+        _next_offscreen_image = (next_image + 1) % swapchain_image_count();
+    } else {
+        VkResult acquire_result = vkAcquireNextImageKHR(_device, _swapchain.handle(), numeric_limits<uint64_t>::max(), _image_available_semaphores_by_frame[frame], nullptr, &next_image);
+        if (acquire_result != VK_SUCCESS && acquire_result != VK_TIMEOUT && acquire_result != VK_NOT_READY) {
+            assert(!"Not Implemented: Need to handle non successful image acquisition.");
+        }
+    }
+    assert(next_image != swapchain_image_count());
+
+    // With more frames in flight than images, an older frame may still be rendering to this image.
+    wait_for_frame_serial(_serials_by_image[next_image]);
+    _serials_by_image[next_image] = serial;
+
+    record_command_buffers(passes, pass_count, frame, next_image);
+
+    // Pending uploads go first in the same submission, so the frame's draws see them. Uploads on the transfer queue
+    // are only waited for by the stages reading them.
+    array<VkCommandBuffer, 2> command_buffers = {};
+    uint32_t command_buffer_count = 0;
+    VkSemaphore upload_semaphore = VK_NULL_HANDLE;
+    VkCommandBuffer upload_command_buffer = _upload_context.take_pending(serial, upload_semaphore);
+    if (upload_command_buffer != VK_NULL_HANDLE) {
+        command_buffers[command_buffer_count++] = upload_command_buffer;
+    }
+    command_buffers[command_buffer_count++] = _command_buffer_handles_by_frame[frame];
+
+    array<VkSemaphore, 2> wait_semaphores = {};
+    array<VkPipelineStageFlags, 2> wait_stages = {};
+    uint32_t wait_semaphore_count = 0;
+    if (!_is_headless) {
+        wait_stages[wait_semaphore_count] = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+        wait_semaphores[wait_semaphore_count++] = _image_available_semaphores_by_frame[frame];
+    }
+    if (upload_semaphore != VK_NULL_HANDLE) {
+        wait_stages[wait_semaphore_count] = VK_PIPELINE_STAGE_TRANSFER_BIT;
+        wait_semaphores[wait_semaphore_count++] = upload_semaphore;
+    }
+    array<VkSemaphore, 2> signal_semaphores = {};
+    array<uint64_t, 2> signal_values = {};
+    uint32_t signal_semaphore_count = 0;
+    if (!_is_headless) {
+        signal_semaphores[signal_semaphore_count++] = _render_finished_semaphores_by_image[next_image];
     }
-    assert(next_image != _swapchain.image_count());
-    _image_indices_by_submission[submission] = next_image;
 
-    record_command_buffers(passes, pass_count, submission, next_image);
+    VkFence fence = VK_NULL_HANDLE;
+    if (_has_timeline_semaphores) {
+        signal_values[signal_semaphore_count] = serial;
+        signal_semaphores[signal_semaphore_count++] = _frame_timeline_semaphore;
+    } else {
+        fence = _fences_by_frame[frame];
+        vkResetFences(_device, 1, &fence);
+    }
 
     VkSubmitInfo submit_info = {};
-    VkSemaphore wait_semaphore = _swapchain_image_available_semaphores[submission];
-    VkPipelineStageFlags wait_stage = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
     submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-    submit_info.waitSemaphoreCount = 1;
-    submit_info.pWaitSemaphores = &wait_semaphore;
-    submit_info.pWaitDstStageMask = &wait_stage;
-    submit_info.commandBufferCount = 1;
-    submit_info.pCommandBuffers = &_command_buffer_handles_by_submission[submission];
+    submit_info.waitSemaphoreCount = wait_semaphore_count;
+    submit_info.pWaitSemaphores = wait_semaphores.data();
+    submit_info.pWaitDstStageMask = wait_stages.data();
+    submit_info.commandBufferCount = command_buffer_count;
+    submit_info.pCommandBuffers = command_buffers.data();
+    submit_info.signalSemaphoreCount = signal_semaphore_count;
+    submit_info.pSignalSemaphores = signal_semaphores.data();
+
+#ifdef VK_KHR_timeline_semaphore
+    array<uint64_t, 2> wait_values = {};
+    VkTimelineSemaphoreSubmitInfoKHR timeline_info = {};
+    if (_has_timeline_semaphores) {
+        // Values for the binary semaphores are ignored.
+        timeline_info.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO_KHR;
+        timeline_info.waitSemaphoreValueCount = submit_info.waitSemaphoreCount;
+        timeline_info.pWaitSemaphoreValues = wait_values.data();
+        timeline_info.signalSemaphoreValueCount = signal_semaphore_count;
+        timeline_info.pSignalSemaphoreValues = signal_values.data();
+        submit_info.pNext = &timeline_info;
+    }
+#endif
 
-    VkFence fence = _fences_by_submission[submission];
     vkQueueSubmit(_graphics_queue, 1, &submit_info, fence);
+    _serials_by_frame[frame] = serial;
+
+    if (!_is_headless) {
+        //
+        // Present the frame
+        //
+        VkPresentInfoKHR present_info = {};
+        VkSwapchainKHR swapchain_handle = _swapchain.handle();
+        present_info.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
+        present_info.waitSemaphoreCount = 1;
+        present_info.pWaitSemaphores = &_render_finished_semaphores_by_image[next_image];
+        present_info.swapchainCount = 1;
+        present_info.pSwapchains = &swapchain_handle;
+        present_info.pImageIndices = &next_image;
+        vkQueuePresentKHR(_present_queue, &present_info);
+    }
 
-    // Wait for the oldest command buffers to finsh execution.
-    uint32_t oldest_submission = _submissions.front();
-    _submissions.pop();
-    _submissions.push(oldest_submission);
+    _is_frame_ready = false;
 
-    VkFence oldest_submission_fence = _fences_by_submission[oldest_submission];
-    vkWaitForFences(_device, 1, &oldest_submission_fence, VK_TRUE, numeric_limits<uint64_t>::max());
-    vkResetFences(_device, 1, &oldest_submission_fence);
+    // In low latency mode the wait is left to the caller, so it can happen right before game logic instead of right
+    // after the previous frame was submitted.
+    if (!_is_low_latency) {
+        wait_for_next_frame();
+    }
+}
 
-    //
-    // Present the previous frame
-    //
-    VkPresentInfoKHR present_info = {};
-    VkSwapchainKHR swapchain_handle = _swapchain.handle();
-    //VkResult present_result = VK_RESULT_MAX_ENUM;
-    present_info.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
-    present_info.swapchainCount = 1;
-    present_info.pSwapchains = &swapchain_handle;
-    present_info.pImageIndices = &next_image;
-    // TODO: This was commented out for some reason, but I can't remember why. Need to look into this again.
-    //present_info.pResults = &present_result;
-    vkQueuePresentKHR(_present_queue, &present_info);
+void VulkanRenderer::wait_for_next_frame() {
+    if (_is_frame_ready) {
+        return;
+    }
 
-    // We can now delete the resources associated with this submission
-    delete_resources_for_image_index(oldest_submission);
+    // Move on to the next frame. Its previous submission must finish before its command buffers are reused, after
+    // which the resources queued for deletion up to that submission are no longer in use. Deletions are keyed by
+    // serial rather than by frame, so resources queued before this wait are kept until the next submission finishes.
+    _frame_index = (_frame_index + 1) % _frame_count;
+    ++_frame_serial;
+    wait_for_frame_serial(_serials_by_frame[_frame_index]);
+    delete_completed_resources();
+    update_frame_resources(_frame_index);
+    for (uint32_t i = 0; i < _recording_thread_count; ++i) {
+        _recording_arenas[_frame_index * _recording_thread_count + i].reset();
+    }
+    _is_frame_ready = true;
+}
+
+void VulkanRenderer::flush_uploads() {
+    _upload_context.flush();
 }
 
-void VulkanRenderer::record_command_buffers(const PassSubmissionInfo *passes, uint32_t pass_count, uint32_t submission, uint32_t image_index) {
-    VulkanCommandPool &pool = _command_pools_by_submission[submission];
-    VulkanCommandBuffer &buffer = _command_buffers_by_submission[submission];
+void VulkanRenderer::record_command_buffers(const PassSubmissionInfo *passes, uint32_t pass_count, uint32_t frame_index, uint32_t image_index) {
+    VulkanCommandPool &pool = _command_pools_by_frame[frame_index];
+    VulkanCommandBuffer &buffer = _command_buffers_by_frame[frame_index];
 
     pool.reset_buffers();
+    if (_recording_workers != nullptr) {
+        for (uint32_t i = 0; i < _recording_thread_count; ++i) {
+            _recording_command_pools[frame_index * _recording_thread_count + i].reset_buffers();
+        }
+    }
+    if (_sort_draws) {
+        passes = sort_pass_draws(passes, pass_count, _recording_arenas[frame_index * _recording_thread_count]);
+    }
+
     buffer.record(passes, pass_count, image_index);
+    _last_submission_stats = buffer.stats();
+}
+
+void VulkanRenderer::wait_for_frame_serial(uint64_t serial) {
+    if (serial <= _completed_frame_serial) {
+        return;
+    }
+
+#ifdef VK_KHR_timeline_semaphore
+    if (_has_timeline_semaphores) {
+        VkSemaphoreWaitInfoKHR wait_info = {};
+        wait_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO_KHR;
+        wait_info.semaphoreCount = 1;
+        wait_info.pSemaphores = &_frame_timeline_semaphore;
+        wait_info.pValues = &serial;
+        _wait_semaphores(_device, &wait_info, numeric_limits<uint64_t>::max());
+        _completed_frame_serial = serial;
+        return;
+    }
+#endif
+
+    // Frames are submitted to a single queue in order, so the fence of the frame with the given serial also covers all
+    // frames before it. If no frame slot holds the serial anymore, it was already waited on before the slot was reused.
+    for (uint32_t i = 0; i < _frame_count; ++i) {
+        if (_serials_by_frame[i] == serial) {
+            VkFence fence = _fences_by_frame[i];
+            vkWaitForFences(_device, 1, &fence, VK_TRUE, numeric_limits<uint64_t>::max());
+            break;
+        }
+    }
+    _completed_frame_serial = serial;
+}
+
+VkResult VulkanRenderer::create_frame_timeline_semaphore() {
+#ifdef VK_KHR_timeline_semaphore
+    _wait_semaphores = reinterpret_cast<PFN_vkWaitSemaphoresKHR>(
+        vkGetDeviceProcAddr(_device, "vkWaitSemaphoresKHR")
+    );
+    if (_wait_semaphores == nullptr) {
+        return VK_ERROR_EXTENSION_NOT_PRESENT;
+    }
+
+    VkSemaphoreTypeCreateInfoKHR type_info = {};
+    type_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO_KHR;
+    type_info.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE_KHR;
+    type_info.initialValue = 0;
+
+    VkSemaphoreCreateInfo create_info = {};
+    create_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+    create_info.pNext = &type_info;
+
+    return vkCreateSemaphore(_device, &create_info, nullptr, &_frame_timeline_semaphore);
+#else
+    return VK_ERROR_EXTENSION_NOT_PRESENT;
+#endif
 }
 
 VkPhysicalDevice VulkanRenderer::physical_device() const {
@@ -309,33 +695,56 @@ const QueueFamilyIndices& VulkanRenderer::queue_family_indices() const {
     return _queue_family_indices;
 }
 
-VkCommandPool VulkanRenderer::copy_command_pool() const {
-    return _copy_command_pool.handle();
+const VkPhysicalDeviceFeatures &VulkanRenderer::enabled_features() const {
+    return _enabled_features;
+}
+
+const VkPhysicalDeviceLimits &VulkanRenderer::limits() const {
+    return _limits;
+}
+
+VkPipelineCache VulkanRenderer::pipeline_cache() const {
+    return _pipeline_cache.handle();
+}
+
+VulkanPipelineStateCache &VulkanRenderer::pipeline_states() {
+    return _pipeline_states;
+}
+
+VulkanLayoutCache &VulkanRenderer::layouts() {
+    return _layouts;
+}
+
+VulkanUploadContext &VulkanRenderer::upload_context() {
+    return _upload_context;
+}
+
+TaskQueue &VulkanRenderer::background_tasks() {
+    return *_background_tasks;
 }
 
 VkQueue VulkanRenderer::graphics_queue() const {
     return _graphics_queue;
 }
 
+VkQueue VulkanRenderer::transfer_queue() const {
+    return _transfer_queue;
+}
+
 bool VulkanRenderer::find_memory_type(
     uint32_t type_filter,
     VkMemoryPropertyFlags properties,
     uint32_t &found_memory_type
 ) const {
-    for (uint32_t i = 0; i < _memory_properties.memoryTypeCount; ++i) {
-        if (type_filter & (1 << i)
-            && _memory_properties.memoryTypes[i].propertyFlags & properties
-        ) {
-            found_memory_type = i;
-            return true;
-        }
-    }
-    return false;
+    VulkanMemoryRequest request;
+    request.required = properties;
+    return choose_memory_type(_memory_properties, nullptr, type_filter, request, 0, found_memory_type);
 }
 
 VkResult VulkanRenderer::create_instance(
     const VulkanContext *context,
-    VkInstance &instance
+    VkInstance &instance,
+    bool &has_physical_device_properties2
 ) {
     VkApplicationInfo app_info = {};
     app_info.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
@@ -349,14 +758,31 @@ VkResult VulkanRenderer::create_instance(
     create_info.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
     create_info.pApplicationInfo = &app_info;
 
-    const char **needed_extensions;
-    unsigned int needed_extensions_count = 0;
-    needed_extensions = context->get_required_instance_extensions(
-        &needed_extensions_count
+    const char **required_extensions;
+    unsigned int required_extensions_count = 0;
+    required_extensions = context->get_required_instance_extensions(
+        &required_extensions_count
     );
+    vector<const char *> needed_extensions(required_extensions, required_extensions + required_extensions_count);
+
+    has_physical_device_properties2 = false;
+#ifdef VK_KHR_get_physical_device_properties2
+    if (instance_has_extension(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME)) {
+        has_physical_device_properties2 = true;
+        bool is_required = false;
+        for (const char *extension : needed_extensions) {
+            if (strcmp(extension, VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME) == 0) {
+                is_required = true;
+            }
+        }
+        if (!is_required) {
+            needed_extensions.push_back(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME);
+        }
+    }
+#endif
 
-    create_info.enabledExtensionCount = needed_extensions_count;
-    create_info.ppEnabledExtensionNames = needed_extensions;
+    create_info.enabledExtensionCount = static_cast<uint32_t>(needed_extensions.size());
+    create_info.ppEnabledExtensionNames = needed_extensions.data();
 
     // TODO: Need mechanism for turning validation layers on or off.
     //array<const char *, 0> validation_layers = {};
@@ -372,6 +798,23 @@ VkResult VulkanRenderer::create_instance(
     return vkCreateInstance(&create_info, nullptr, &instance);
 }
 
+bool VulkanRenderer::instance_has_extension(const char *extension_name) {
+    uint32_t available_extension_count = 0;
+    vkEnumerateInstanceExtensionProperties(nullptr, &available_extension_count, nullptr);
+
+    unique_ptr<VkExtensionProperties[]> available_extensions(
+        new VkExtensionProperties[available_extension_count]
+    );
+    vkEnumerateInstanceExtensionProperties(nullptr, &available_extension_count, available_extensions.get());
+
+    for (uint32_t i = 0; i < available_extension_count; ++i) {
+        if (strcmp(available_extensions[i].extensionName, extension_name) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
 bool VulkanRenderer::is_physical_device_suitable(
     VkPhysicalDevice device,
     VkSurfaceKHR surface,
@@ -382,17 +825,22 @@ bool VulkanRenderer::is_physical_device_suitable(
     if (!queue_family_indices.is_complete()) {
         return false;
     }
-    if (!physical_device_has_required_extensions(device)) {
+    if (!physical_device_has_required_extensions(device, surface == VK_NULL_HANDLE)) {
         return false;
     }
+    if (surface == VK_NULL_HANDLE) {
+        // Headless, there is no swapchain to check.
+        return true;
+    }
     get_swap_chain_info(device, surface, swapchain_info);
     return swapchain_is_adequate(swapchain_info);
 }
 
 bool VulkanRenderer::physical_device_has_required_extensions(
-    VkPhysicalDevice device
+    VkPhysicalDevice device,
+    bool is_headless
 ) {
-    vector<const char *> required_extensions = get_required_device_extensions();
+    vector<const char *> required_extensions = get_required_device_extensions(is_headless);
 
     unordered_set<string> unfound_extensions(
         required_extensions.begin(),
@@ -425,6 +873,23 @@ bool VulkanRenderer::physical_device_has_required_extensions(
     return unfound_extensions.empty();
 }
 
+bool VulkanRenderer::physical_device_has_extension(VkPhysicalDevice device, const char *extension_name) {
+    unsigned int available_extension_count;
+    vkEnumerateDeviceExtensionProperties(device, nullptr, &available_extension_count, nullptr);
+
+    unique_ptr<VkExtensionProperties[]> available_extensions(
+        new VkExtensionProperties[available_extension_count]
+    );
+    vkEnumerateDeviceExtensionProperties(device, nullptr, &available_extension_count, available_extensions.get());
+
+    for (unsigned int i = 0; i < available_extension_count; ++i) {
+        if (strcmp(available_extensions[i].extensionName, extension_name) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
 bool VulkanRenderer::swapchain_is_adequate(const SwapchainInfo &info) {
     return info.format_count > 0 && info.present_mode_count > 0;
 }
@@ -450,12 +915,27 @@ QueueFamilyIndices VulkanRenderer::find_queue_family_indices(
     );
 
     QueueFamilyIndices indices;
+    bool is_transfer_family_dedicated = false;
     for (unsigned int i = 0; i < queue_family_count; ++i) {
         const VkQueueFamilyProperties &family = queue_families[i];
         if (family.queueCount > 0) {
             if (family.queueFlags & VK_QUEUE_GRAPHICS_BIT) {
                 indices.graphics_family = i;
             }
+            else if (!is_transfer_family_dedicated
+                && family.queueFlags & (VK_QUEUE_TRANSFER_BIT | VK_QUEUE_COMPUTE_BIT)
+            ) {
+                // Prefer a transfer only family, which usually maps to a dedicated copy engine. Compute families
+                // support transfers as well.
+                indices.transfer_family = i;
+                is_transfer_family_dedicated = (family.queueFlags & VK_QUEUE_COMPUTE_BIT) == 0;
+            }
+
+            if (surface == VK_NULL_HANDLE) {
+                // Nothing is presented when headless, so the graphics queue stands in for the present queue.
+                indices.present_family = indices.graphics_family;
+                continue;
+            }
 
             VkBool32 surface_supported;
             vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface, &surface_supported);
@@ -497,25 +977,60 @@ VkPhysicalDevice VulkanRenderer::find_suitable_physical_device(
 VkResult VulkanRenderer::create_logical_device(
     VkPhysicalDevice physical_device,
     QueueFamilyIndices queue_family_indices,
+    bool is_headless,
+    bool enable_timeline_semaphores,
+    const VkPhysicalDeviceFeatures &enabled_features,
     VkDevice &logical_device
 ) {
     float queue_priority = 1.0f;
-    VkDeviceQueueCreateInfo queue_create_info = {};
-    queue_create_info.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
-    queue_create_info.queueFamilyIndex = queue_family_indices.graphics_family;
-    queue_create_info.queueCount = 1;
-    queue_create_info.pQueuePriorities = &queue_priority;
+    uint32_t families[] = {
+        queue_family_indices.graphics_family,
+        queue_family_indices.present_family,
+        queue_family_indices.transfer_family
+    };
+
+    // One queue for each distinct family in use.
+    vector<VkDeviceQueueCreateInfo> queue_create_infos;
+    for (uint32_t family : families) {
+        bool is_used = family != static_cast<uint32_t>(-1);
+        for (const VkDeviceQueueCreateInfo &info : queue_create_infos) {
+            is_used = is_used && info.queueFamilyIndex != family;
+        }
+        if (!is_used) {
+            continue;
+        }
+
+        VkDeviceQueueCreateInfo queue_create_info = {};
+        queue_create_info.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+        queue_create_info.queueFamilyIndex = family;
+        queue_create_info.queueCount = 1;
+        queue_create_info.pQueuePriorities = &queue_priority;
+        queue_create_infos.push_back(queue_create_info);
+    }
 
-    vector<const char *> extensions = get_required_device_extensions();
+    vector<const char *> extensions = get_required_device_extensions(is_headless);
 
     VkDeviceCreateInfo create_info = {};
     create_info.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
-    create_info.queueCreateInfoCount = 1;
-    create_info.pQueueCreateInfos = &queue_create_info;
+
+#ifdef VK_KHR_timeline_semaphore
+    // The timelineSemaphore feature is required to be supported when the extension is.
+    VkPhysicalDeviceTimelineSemaphoreFeaturesKHR timeline_features = {};
+    timeline_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES_KHR;
+    timeline_features.timelineSemaphore = VK_TRUE;
+    if (enable_timeline_semaphores) {
+        extensions.push_back(VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME);
+        create_info.pNext = &timeline_features;
+    }
+#endif
+
+    create_info.queueCreateInfoCount = static_cast<uint32_t>(queue_create_infos.size());
+    create_info.pQueueCreateInfos = queue_create_infos.data();
     create_info.enabledExtensionCount
         = static_cast<unsigned int>(extensions.size());
     create_info.ppEnabledExtensionNames = extensions.data();
     create_info.enabledLayerCount = 0;
+    create_info.pEnabledFeatures = &enabled_features;
 
     return vkCreateDevice(
         physical_device,
@@ -525,7 +1040,10 @@ VkResult VulkanRenderer::create_logical_device(
     );
 }
 
-vector<const char *> VulkanRenderer::get_required_device_extensions() {
+vector<const char *> VulkanRenderer::get_required_device_extensions(bool is_headless) {
+    if (is_headless) {
+        return vector<const char *>();
+    }
     return vector<const char *> {
         VK_KHR_SWAPCHAIN_EXTENSION_NAME
     };
@@ -577,21 +1095,59 @@ VkSurfaceFormatKHR VulkanRenderer::choose_surface_format(
 }
 
 VkPresentModeKHR VulkanRenderer::choose_present_mode(
-    const SwapchainInfo &/*info*/
+    const SwapchainInfo &info,
+    PresentMode requested_mode
 ) {
+    // Fall back to the closest mode with the same blocking behaviour first.
+    array<PresentMode, 3> candidates;
+    switch (requested_mode) {
+        case PresentMode::Mailbox:
+            candidates = {PresentMode::Mailbox, PresentMode::Immediate, PresentMode::Fifo};
+            break;
+        case PresentMode::Immediate:
+            candidates = {PresentMode::Immediate, PresentMode::Mailbox, PresentMode::Fifo};
+            break;
+        case PresentMode::FifoRelaxed:
+            candidates = {PresentMode::FifoRelaxed, PresentMode::Fifo, PresentMode::Fifo};
+            break;
+        case PresentMode::Fifo:
+        default:
+            candidates = {PresentMode::Fifo, PresentMode::Fifo, PresentMode::Fifo};
+            break;
+    }
+
+    for (PresentMode candidate : candidates) {
+        VkPresentModeKHR mode = translate_present_mode(candidate);
+        if (is_present_mode_supported(info, mode)) {
+            return mode;
+        }
+    }
+
     // VK_PRESENT_MODE_FIFO_KHR is guaranteed to always be available.
-    VkPresentModeKHR selected_mode = VK_PRESENT_MODE_FIFO_KHR;
-    //VkPresentModeKHR selected_mode = VK_PRESENT_MODE_IMMEDIATE_KHR;
+    return VK_PRESENT_MODE_FIFO_KHR;
+}
 
-    // TODO: Make this smarter and capable of choosing different modes.
-//    for (unsigned int i = 0; i < info.present_mode_count; ++i) {
-//        VkPresentModeKHR mode = info.present_modes[i];
-//        if (mode == VK_PRESENT_MODE_MAILBOX_KHR) {
-//            return mode;
-//        }
-//    }
+bool VulkanRenderer::is_present_mode_supported(const SwapchainInfo &info, VkPresentModeKHR mode) {
+    for (uint32_t i = 0; i < info.present_mode_count; ++i) {
+        if (info.present_modes[i] == mode) {
+            return true;
+        }
+    }
+    return false;
+}
 
-    return selected_mode;
+VkPresentModeKHR VulkanRenderer::translate_present_mode(PresentMode mode) {
+    switch (mode) {
+        case PresentMode::Fifo:
+            return VK_PRESENT_MODE_FIFO_KHR;
+        case PresentMode::FifoRelaxed:
+            return VK_PRESENT_MODE_FIFO_RELAXED_KHR;
+        case PresentMode::Mailbox:
+            return VK_PRESENT_MODE_MAILBOX_KHR;
+        case PresentMode::Immediate:
+            return VK_PRESENT_MODE_IMMEDIATE_KHR;
+    }
+    return VK_PRESENT_MODE_FIFO_KHR;
 }
 
 VkExtent2D VulkanRenderer::choose_swap_extent(const SwapchainInfo &info) {
@@ -620,129 +1176,168 @@ VkExtent2D VulkanRenderer::choose_swap_extent(const SwapchainInfo &info) {
     return extent;
 }
 
-void VulkanRenderer::create_buffer(
+bool VulkanRenderer::has_unified_memory(const VkPhysicalDeviceMemoryProperties &memory_properties) {
+    // The largest device local heap is where resources live. When host visible memory types are backed by it, as on
+    // integrated GPUs, writing to resources directly is as fast for the GPU to read as a staged copy.
+    uint32_t largest_heap = memory_properties.memoryHeapCount;
+    for (uint32_t i = 0; i < memory_properties.memoryHeapCount; ++i) {
+        const VkMemoryHeap &heap = memory_properties.memoryHeaps[i];
+        if (heap.flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT
+            && (largest_heap == memory_properties.memoryHeapCount
+                || heap.size > memory_properties.memoryHeaps[largest_heap].size)
+        ) {
+            largest_heap = i;
+        }
+    }
+
+    VkMemoryPropertyFlags unified_flags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT
+        | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+    for (uint32_t i = 0; i < memory_properties.memoryTypeCount; ++i) {
+        const VkMemoryType &type = memory_properties.memoryTypes[i];
+        if (type.heapIndex == largest_heap && (type.propertyFlags & unified_flags) == unified_flags) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool VulkanRenderer::allocate_memory(
+    const VkMemoryRequirements &requirements,
+    const VulkanMemoryRequest &request,
+    bool is_linear,
+    VulkanAllocation &allocation
+) {
+    VkDeviceSize heap_usage[VK_MAX_MEMORY_HEAPS];
+    _memory_allocator.heap_usage(heap_usage);
+
+    uint32_t type_filter = requirements.memoryTypeBits;
+    uint32_t memory_type_index;
+    while (choose_memory_type(
+        _memory_properties,
+        heap_usage,
+        type_filter,
+        request,
+        requirements.size,
+        memory_type_index
+    )) {
+        if (_memory_allocator.allocate(requirements, memory_type_index, is_linear, allocation)) {
+            return true;
+        }
+        type_filter &= ~(1u << memory_type_index);
+    }
+    return false;
+}
+
+void VulkanRenderer::free_memory(const VulkanAllocation &allocation) {
+    _memory_allocator.free(allocation);
+}
+
+bool VulkanRenderer::create_buffer(
     VkDeviceSize size,
     VkBufferUsageFlags usage,
-    VkMemoryPropertyFlags memory_properties,
+    VkMemoryPropertyFlags required_memory_properties,
+    VkMemoryPropertyFlags preferred_memory_properties,
     VkBuffer &buffer,
-    VkDeviceMemory &device_memory
-) const {
+    VulkanAllocation &allocation
+) {
     VkBufferCreateInfo create_info = {};
     create_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
     create_info.size = size;
     create_info.usage = usage;
     create_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
     if (vkCreateBuffer(_device, &create_info, nullptr, &buffer) != VK_SUCCESS) {
-        return;
+        buffer = VK_NULL_HANDLE;
+        return false;
     }
 
     VkMemoryRequirements memory_requirements;
     vkGetBufferMemoryRequirements(_device, buffer, &memory_requirements);
-    uint32_t memory_type_index;
-    if (!find_memory_type(
-        memory_requirements.memoryTypeBits,
-        memory_properties,
-        memory_type_index
-    )) {
-        return;
+    VulkanMemoryRequest request;
+    request.required = required_memory_properties;
+    request.preferred = preferred_memory_properties;
+    if (!allocate_memory(memory_requirements, request, true, allocation)) {
+        // Nothing has used the buffer yet, so it can go right away.
+        vkDestroyBuffer(_device, buffer, nullptr);
+        buffer = VK_NULL_HANDLE;
+        return false;
     }
 
-    VkDeviceSize actual_size = max(memory_requirements.size, size);
+    vkBindBufferMemory(_device, buffer, allocation.memory, allocation.offset);
+    return true;
+}
 
-    VkMemoryAllocateInfo alloc_info = {};
-    alloc_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    alloc_info.allocationSize = actual_size;
-    alloc_info.memoryTypeIndex = memory_type_index;
-    if (vkAllocateMemory(_device, &alloc_info, nullptr, &device_memory) != VK_SUCCESS) {
-        return;
+bool VulkanRenderer::create_image_memory(
+    VkImage image,
+    VkMemoryPropertyFlags memory_properties,
+    VulkanAllocation &allocation
+) {
+    VkMemoryRequirements memory_requirements;
+    vkGetImageMemoryRequirements(_device, image, &memory_requirements);
+    VulkanMemoryRequest request;
+    request.required = memory_properties;
+    if (!allocate_memory(memory_requirements, request, false, allocation)) {
+        return false;
     }
 
-
-
-    vkBindBufferMemory(_device, buffer, device_memory, 0);
+    vkBindImageMemory(_device, image, allocation.memory, allocation.offset);
+    return true;
 }
 
-VkResult VulkanRenderer::copy_buffer(VkBuffer src, VkBuffer dest, VkDeviceSize size) const {
-    VkCommandBufferAllocateInfo alloc_info = {};
-    alloc_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-    alloc_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-    alloc_info.commandPool = _copy_command_pool.handle();
-    alloc_info.commandBufferCount = 1;
-
-    VkCommandBuffer command_buffer;
-    VkResult result = vkAllocateCommandBuffers(_device, &alloc_info, &command_buffer);
-    if (result != VK_SUCCESS) {
-        return result;
+void VulkanRenderer::delete_when_safe(unique_ptr<SwapchainSafeDeleteable> deleteable) {
+    // The resource may be used by any submission up to and including the next one, uploads included.
+    uint64_t serial = next_submission_serial();
+    if (_safe_deletables.empty() || _safe_deletables.back().serial != serial) {
+        _safe_deletables.push_back(SafeDeletables());
+        _safe_deletables.back().serial = serial;
     }
+    _safe_deletables.back().deletables.emplace_back(move(deleteable));
+}
 
-    VkCommandBufferBeginInfo begin_info = {};
-    begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-    begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-
-    vkBeginCommandBuffer(command_buffer, &begin_info);
-
-    VkBufferCopy region = {};
-    region.srcOffset = 0;
-    region.dstOffset = 0;
-    region.size = size;
-    vkCmdCopyBuffer(command_buffer, src, dest, 1, &region);
-
-    vkEndCommandBuffer(command_buffer);
-
-    VkSubmitInfo submit_info = {};
-    submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-    submit_info.commandBufferCount = 1;
-    submit_info.pCommandBuffers = &command_buffer;
-
-    VkFenceCreateInfo fence_info = {};
-    fence_info.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-    fence_info.flags = 0;
-    fence_info.pNext = nullptr;
-
-    VkFence fence;
-    vkCreateFence(_device, &fence_info, nullptr, &fence);
-
-    vkQueueSubmit(_graphics_queue, 1, &submit_info, fence);
+uint64_t VulkanRenderer::make_object_id() {
+    return _next_object_id++;
+}
 
-    result = VK_TIMEOUT;
-    while (result == VK_TIMEOUT) {
-        result = vkWaitForFences(_device, 1, &fence, VK_FALSE, numeric_limits<uint64_t>::max());
+void VulkanRenderer::delete_completed_resources() {
+    while (!_safe_deletables.empty() && _safe_deletables.front().serial <= _completed_frame_serial) {
+        // Deleting may queue more deletions, so the group is taken off the queue first.
+        vector<unique_ptr<SwapchainSafeDeleteable>> deletables = move(_safe_deletables.front().deletables);
+        _safe_deletables.pop_front();
+        for (unique_ptr<SwapchainSafeDeleteable> &deletable : deletables) {
+            deletable->delete_resources(*this);
+        }
     }
-
-    vkDestroyFence(_device, fence, nullptr);
-    vkFreeCommandBuffers(_device, _copy_command_pool.handle(), 1, &command_buffer);
-
-    return result;
 }
 
-void VulkanRenderer::delete_when_safe(unique_ptr<SwapchainSafeDeleteable> deleteable) {
-    vector<unique_ptr<SwapchainSafeDeleteable>> &list_for_next_swapchain_image =
-            _safe_deletables_by_image_index[next_submission_index()];
-
-    list_for_next_swapchain_image.emplace_back(move(deleteable));
+void VulkanRenderer::update_when_frames_available(VulkanFrameResource *resource) {
+    if (find(_stale_frame_resources.begin(), _stale_frame_resources.end(), resource)
+        == _stale_frame_resources.end()
+    ) {
+        _stale_frame_resources.push_back(resource);
+    }
 }
 
-void VulkanRenderer::delete_resources_for_image_index(uint32_t image_index) {
-    vector<unique_ptr<SwapchainSafeDeleteable>> &list_for_next_swapchain_image =
-        _safe_deletables_by_image_index[image_index];
-
-    for (unique_ptr<SwapchainSafeDeleteable> &deletable : list_for_next_swapchain_image) {
-        deletable->delete_resources(*this);
-    }
+void VulkanRenderer::cancel_frame_updates(VulkanFrameResource *resource) {
+    _stale_frame_resources.erase(
+        remove(_stale_frame_resources.begin(), _stale_frame_resources.end(), resource),
+        _stale_frame_resources.end()
+    );
+}
 
-    list_for_next_swapchain_image.clear();
+void VulkanRenderer::update_frame_resources(uint32_t frame_index) {
+    _stale_frame_resources.erase(
+        remove_if(
+            _stale_frame_resources.begin(),
+            _stale_frame_resources.end(),
+            [frame_index](VulkanFrameResource *resource) { return resource->update_frame(frame_index); }
+        ),
+        _stale_frame_resources.end()
+    );
 }
 
 
 void VulkanRenderer::finish_enqueued_command_buffers() {
-    // Wait on all fences which represent command buffer executions in progress. Don't wait on the last fence in the
-    // queue, since it represents the next queue submission which hasn't happened yet.
-    while (_submissions.size() > 1) {
-        uint32_t submission = _submissions.front();
-        _submissions.pop();
-        VkFence fence = _fences_by_submission[submission];
-        vkWaitForFences(_device, 1, &fence, /* wait all? */ VK_TRUE, /* timeout */ numeric_limits<uint64_t>::max());
-    }
+    // Waiting on the most recently submitted frame also waits on every frame submitted before it.
+    wait_for_frame_serial(_is_frame_ready ? _frame_serial - 1 : _frame_serial);
 }
 
 VkFormat VulkanRenderer::translate_texture_format(TextureFormat format) {
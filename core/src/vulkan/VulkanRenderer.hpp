@@ -4,12 +4,25 @@
 #include <vulkan/vulkan.h>
 #include <giygas/VulkanContext.hpp>
 #include "VulkanCommandPool.hpp"
+#include "VulkanUploadContext.hpp"
+#include "VulkanMemoryAllocator.hpp"
+#include "VulkanMemoryTypes.hpp"
 #include "QueueFamilyIndices.hpp"
 #include "SwapchainInfo.hpp"
 #include "VulkanSwapchain.hpp"
+#include "VulkanOffscreenSwapchain.hpp"
 #include "SwapchainSafeDeleteable.hpp"
+#include "VulkanFrameResource.hpp"
+#include "VulkanPipelineCache.hpp"
+#include "VulkanPipelineStateCache.hpp"
+#include "VulkanLayoutCache.hpp"
+#include "../TaskQueue.hpp"
+#include "../WorkerPool.hpp"
+#include "../LinearArena.hpp"
+#include <atomic>
+#include <deque>
+#include <mutex>
 #include <limits>
-#include <queue>
 
 
 namespace giygas {
@@ -24,32 +37,103 @@ namespace giygas {
         QueueFamilyIndices _queue_family_indices;
         VkQueue _graphics_queue = nullptr;
         VkQueue _present_queue = nullptr;
+        VkQueue _transfer_queue = nullptr;
         VulkanSwapchain _swapchain;
+        VulkanOffscreenSwapchain _offscreen_swapchain;
+        bool _is_headless = false;
+        bool _is_low_latency = false;
+        bool _sort_draws = false;
+        VkPresentModeKHR _present_mode = VK_PRESENT_MODE_FIFO_KHR;
         VkPhysicalDeviceMemoryProperties _memory_properties = {};
-        VulkanCommandPool _copy_command_pool;
-        unique_ptr<VkSemaphore[]> _swapchain_image_available_semaphores;
+        bool _is_unified_memory = false;
+        VkPhysicalDeviceFeatures _enabled_features = {};
+        VkPhysicalDeviceLimits _limits = {};
+        VulkanMemoryAllocator _memory_allocator;
+        VulkanUploadContext _upload_context;
+        VulkanPipelineCache _pipeline_cache;
+        VulkanPipelineStateCache _pipeline_states;
+        VulkanLayoutCache _layouts;
+        unique_ptr<TaskQueue> _background_tasks;
+
+        // Runs create_pipelines_async() batches, kept apart from _background_tasks so a long batch does not hold up
+        // texture loads.
+        unique_ptr<TaskQueue> _pipeline_tasks;
+
+        // Compiles batches of pipelines. Made on first use; parallel_for() runs one batch at a time, so batches
+        // started from different threads take turns.
+        unique_ptr<WorkerPool> _pipeline_workers;
+        std::mutex _pipeline_workers_mutex;
         VkDescriptorPool _shared_descriptor_pool = nullptr;
 
-        std::queue<uint32_t> _submissions;
-        unique_ptr<VkFence[]> _fences_by_submission;
-        unique_ptr<VulkanCommandPool[]> _command_pools_by_submission;
-        unique_ptr<VulkanCommandBuffer[]> _command_buffers_by_submission;
-        unique_ptr<VkCommandBuffer[]> _command_buffer_handles_by_submission;
-        unique_ptr<uint32_t[]> _image_indices_by_submission;
-
-        uint32_t _previous_swapchain_image_index = std::numeric_limits<uint32_t>::max();
+        //
+        // Per frame resources. Frames cycle through _frame_count slots, independently of the swapchain images.
+        //
+        uint32_t _frame_count = 0;
+        uint32_t _frame_index = 0;
+        bool _is_frame_ready = true;
+        unique_ptr<VkSemaphore[]> _image_available_semaphores_by_frame;
+        unique_ptr<VkFence[]> _fences_by_frame;
+        unique_ptr<VulkanCommandPool[]> _command_pools_by_frame;
+        unique_ptr<VulkanCommandBuffer[]> _command_buffers_by_frame;
+        unique_ptr<VkCommandBuffer[]> _command_buffer_handles_by_frame;
+
+        // Resources queued for deletion, grouped by the serial of the first submission which can no longer use them.
+        // Oldest first.
+        struct SafeDeletables {
+            uint64_t serial;
+            vector<unique_ptr<SwapchainSafeDeleteable>> deletables;
+        };
+        std::deque<SafeDeletables> _safe_deletables;
+
+        // Resources with copies which are not up to date yet.
+        vector<VulkanFrameResource *> _stale_frame_resources;
+
+        // Parallel recording. Each frame has one command pool and one scratch arena per recording thread, stored frame
+        // major.
+        uint32_t _recording_thread_count = 1;
+        unique_ptr<WorkerPool> _recording_workers;
+        unique_ptr<VulkanCommandPool[]> _recording_command_pools;
+        unique_ptr<LinearArena[]> _recording_arenas;
+        SubmissionStats _last_submission_stats;
+
+        // Every submitted frame gets an increasing serial, which is also the value signalled on the timeline
+        // semaphore when timeline semaphores are available. Serial 0 is never submitted.
+        uint64_t _frame_serial = 1;
+        // Uploads recorded on background threads read the completed serial to recycle staging memory.
+        std::atomic<uint64_t> _completed_frame_serial;
+
+        std::atomic<uint64_t> _next_object_id;
+        unique_ptr<uint64_t[]> _serials_by_frame;
+        // On a Vulkan 1.0 instance, device extensions like VK_KHR_timeline_semaphore need this instance extension.
+        bool _has_physical_device_properties2 = false;
+        bool _has_timeline_semaphores = false;
+        VkSemaphore _frame_timeline_semaphore = VK_NULL_HANDLE;
+#ifdef VK_KHR_timeline_semaphore
+        PFN_vkWaitSemaphoresKHR _wait_semaphores = nullptr;
+#endif
 
-        unique_ptr<vector<unique_ptr<SwapchainSafeDeleteable>>[]> _safe_deletables_by_image_index;
+        //
+        // Per swapchain image resources
+        //
+        unique_ptr<VkSemaphore[]> _render_finished_semaphores_by_image;
+        unique_ptr<uint64_t[]> _serials_by_image;
+        uint32_t _next_offscreen_image = 0;
 
-        void delete_resources_for_image_index(uint32_t submission_index);
+        void delete_completed_resources();
+        void update_frame_resources(uint32_t frame_index);
         void finish_enqueued_command_buffers();
-        void record_command_buffers(const PassSubmissionInfo *passes, uint32_t pass_count, uint32_t submission_index, uint32_t image_index);
+        void record_command_buffers(const PassSubmissionInfo *passes, uint32_t pass_count, uint32_t frame_index, uint32_t image_index);
+        void wait_for_frame_serial(uint64_t serial);
+        VkResult create_frame_timeline_semaphore();
 
         static VkResult create_instance(
             const VulkanContext *context,
-            VkInstance &instance
+            VkInstance &instance,
+            bool &has_physical_device_properties2
         );
 
+        static bool instance_has_extension(const char *extension_name);
+
         static bool is_physical_device_suitable(
             VkPhysicalDevice device,
             VkSurfaceKHR surface,
@@ -57,7 +141,8 @@ namespace giygas {
             SwapchainInfo &swapchain_info
         );
 
-        static bool physical_device_has_required_extensions(VkPhysicalDevice device);
+        static bool physical_device_has_required_extensions(VkPhysicalDevice device, bool is_headless);
+        static bool physical_device_has_extension(VkPhysicalDevice device, const char *extension_name);
         static bool swapchain_is_adequate(const SwapchainInfo& info);
 
         static QueueFamilyIndices find_queue_family_indices(
@@ -75,10 +160,13 @@ namespace giygas {
         static VkResult create_logical_device(
             VkPhysicalDevice physical_device,
             QueueFamilyIndices queue_family_indices,
+            bool is_headless,
+            bool enable_timeline_semaphores,
+            const VkPhysicalDeviceFeatures &enabled_features,
             VkDevice &logical_device
         );
 
-        static vector<const char *> get_required_device_extensions();
+        static vector<const char *> get_required_device_extensions(bool is_headless);
 
         static void get_swap_chain_info(
             VkPhysicalDevice device,
@@ -87,8 +175,13 @@ namespace giygas {
         );
 
         static VkSurfaceFormatKHR choose_surface_format(const SwapchainInfo &info);
-        static VkPresentModeKHR choose_present_mode(const SwapchainInfo &info);
+        static VkPresentModeKHR choose_present_mode(const SwapchainInfo &info, PresentMode requested_mode);
+        static bool is_present_mode_supported(const SwapchainInfo &info, VkPresentModeKHR mode);
+        static VkPresentModeKHR translate_present_mode(PresentMode mode);
+        void compile_pipelines(const PipelineCreateParameters *params, Pipeline *const *pipelines, uint32_t count);
+
         static VkExtent2D choose_swap_extent(const SwapchainInfo &info);
+        static bool has_unified_memory(const VkPhysicalDeviceMemoryProperties &memory_properties);
 
     public:
         explicit VulkanRenderer(VulkanContext *context);
@@ -102,13 +195,16 @@ namespace giygas {
         // Renderer implementation
         //
 
-        void initialize() override;
+        using Renderer::initialize;
+        void initialize(const RendererInitParameters &params) override;
         RendererType renderer_type() const override;
         VertexBuffer *make_vertex_buffer(VertexBufferCreateFlags flags) override;
         IndexBuffer<uint32_t> *make_index_buffer_32(IndexBufferCreateFlags flags) override;
         IndexBuffer<uint16_t> *make_index_buffer_16(IndexBufferCreateFlags flags) override;
         IndexBuffer<uint8_t> *make_index_buffer_8(IndexBufferCreateFlags flags) override;
+        IndirectBuffer *make_indirect_buffer(IndirectBufferCreateFlags flags) override;
         UniformBuffer *make_uniform_buffer() override;
+        StreamBuffer *make_stream_buffer(uint32_t capacity) override;
         Shader *make_shader() override;
         Texture *make_texture() override;
         Sampler *make_sampler() override;
@@ -117,10 +213,26 @@ namespace giygas {
         RenderPass *make_render_pass() override;
         Framebuffer *make_framebuffer() override;
         Pipeline *make_pipeline() override;
+        void create_pipelines(
+            const PipelineCreateParameters *params,
+            Pipeline *const *pipelines,
+            uint32_t count,
+            bool *is_valid
+        ) override;
+        void create_pipelines_async(
+            const PipelineCreateParameters *params,
+            Pipeline *const *pipelines,
+            uint32_t count,
+            PipelineBatchCallback callback
+        ) override;
 
         const  RenderTarget *swapchain() const override;
 
         void submit(const PassSubmissionInfo *passes, uint32_t pass_count) override;
+        void wait_for_next_frame() override;
+        void flush_uploads() override;
+        const SubmissionStats &last_submission_stats() const override;
+        bool save_pipeline_cache() override;
 
         //
         // VulkanRenderer implementation
@@ -129,8 +241,15 @@ namespace giygas {
         VkPhysicalDevice physical_device() const;
         VkDevice device() const;
         const QueueFamilyIndices &queue_family_indices() const;
-        VkCommandPool copy_command_pool() const;
+        const VkPhysicalDeviceFeatures &enabled_features() const;
+        const VkPhysicalDeviceLimits &limits() const;
+        VkPipelineCache pipeline_cache() const;
+        VulkanPipelineStateCache &pipeline_states();
+        VulkanLayoutCache &layouts();
+        VulkanUploadContext &upload_context();
+        TaskQueue &background_tasks();
         VkQueue graphics_queue() const;
+        VkQueue transfer_queue() const;
 
         bool find_memory_type(
             uint32_t type_filter,
@@ -138,25 +257,58 @@ namespace giygas {
             uint32_t& found_memory_type
         ) const;
 
-        void create_buffer(
+        // Allocates from the best memory type for the request, falling back to the next best types when a heap is
+        // out of memory.
+        bool allocate_memory(
+            const VkMemoryRequirements &requirements,
+            const VulkanMemoryRequest &request,
+            bool is_linear,
+            VulkanAllocation &allocation
+        );
+        void free_memory(const VulkanAllocation &allocation);
+
+        // Returns false, leaving buffer null, when the buffer or its memory could not be created.
+        bool create_buffer(
             VkDeviceSize size,
             VkBufferUsageFlags usage,
-            VkMemoryPropertyFlags memory_properties,
+            VkMemoryPropertyFlags required_memory_properties,
+            VkMemoryPropertyFlags preferred_memory_properties,
             VkBuffer &buffer,
-            VkDeviceMemory &device_memory
-        ) const;
+            VulkanAllocation &allocation
+        );
 
-        VkResult copy_buffer(
-            VkBuffer src,
-            VkBuffer dest,
-            VkDeviceSize size
-        ) const;
+        // Allocates and binds memory for an optimal tiling image.
+        bool create_image_memory(
+            VkImage image,
+            VkMemoryPropertyFlags memory_properties,
+            VulkanAllocation &allocation
+        );
+
+        uint32_t current_frame_index() const;
 
-        uint32_t next_submission_index() const;
+        // Whether the resources of the next frame are available, which is only false in low latency mode between
+        // submit() and wait_for_next_frame().
+        bool is_frame_ready() const;
+        uint64_t next_submission_serial() const;
+        uint64_t completed_frame_serial() const;
+        uint32_t frames_in_flight() const;
+        uint32_t recording_thread_count() const;
+        VkPresentModeKHR present_mode() const;
         uint32_t swapchain_image_count() const;
+        bool is_headless() const;
+        bool is_unified_memory() const;
 
         void delete_when_safe(unique_ptr<SwapchainSafeDeleteable> resource);
 
+        // Returns an id no other object of this renderer has, unlike handles which may be reused once destroyed. Id 0
+        // is never returned.
+        uint64_t make_object_id();
+
+        // Has the resource update its copy for each frame as the frame becomes available, until every copy is up to
+        // date. A resource must cancel pending updates before it is destroyed.
+        void update_when_frames_available(VulkanFrameResource *resource);
+        void cancel_frame_updates(VulkanFrameResource *resource);
+
         static VkFormat translate_texture_format(TextureFormat format);
 
     };
@@ -24,6 +24,7 @@ public:
 VulkanSampler::VulkanSampler(VulkanRenderer *renderer) {
     _renderer = renderer;
     _handle = VK_NULL_HANDLE;
+    _id = 0;
 }
 
 VulkanSampler::~VulkanSampler() {
@@ -54,12 +55,17 @@ void VulkanSampler::create(const SamplerParameters &params) {
     create_info.maxLod = 0;
 
     vkCreateSampler(_renderer->device(), &create_info, nullptr, &_handle);
+    _id = _renderer->make_object_id();
 }
 
 VkSampler VulkanSampler::handle() const {
     return _handle;
 }
 
+uint64_t VulkanSampler::id() const {
+    return _id;
+}
+
 VkFilter VulkanSampler::translate_filter(SamplerFilterMode mode) {
     switch (mode) {
         case SamplerFilterMode::Nearest:
@@ -12,6 +12,7 @@ namespace giygas {
 
         VulkanRenderer *_renderer;
         VkSampler _handle;
+        uint64_t _id;
 
         static VkFilter translate_filter(SamplerFilterMode mode);
         static VkSamplerAddressMode wrap_to_address_mode(SamplerWrapMode mode);
@@ -39,6 +40,9 @@ namespace giygas {
 
         VkSampler handle() const;
 
+        // Identifies the sampler for as long as the renderer lives. 0 until created.
+        uint64_t id() const;
+
 
     };
 
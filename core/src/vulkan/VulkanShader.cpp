@@ -25,6 +25,7 @@ public:
 VulkanShader::VulkanShader(VulkanRenderer *renderer) {
     _renderer = renderer;
     _module = VK_NULL_HANDLE;
+    _id = 0;
 }
 
 VulkanShader::VulkanShader(VulkanShader &&other) noexcept {
@@ -39,7 +40,9 @@ VulkanShader& VulkanShader::operator=(VulkanShader &&other) noexcept {
 void VulkanShader::move_common(VulkanShader &&other) noexcept {
     _renderer = other._renderer;
     _module = other._module;
+    _id = other._id;
     other._module = VK_NULL_HANDLE;
+    other._id = 0;
 }
 
 VulkanShader::~VulkanShader() {
@@ -73,6 +76,7 @@ void VulkanShader::set_code(
     );
 
     _type = type;
+    _id = _renderer->make_object_id();
 }
 
 RendererType VulkanShader::renderer_type() const {
@@ -87,3 +91,6 @@ VkShaderModule VulkanShader::module() const {
     return _module;
 }
 
+uint64_t VulkanShader::id() const {
+    return _id;
+}
@@ -14,6 +14,7 @@ namespace giygas {
         VulkanRenderer *_renderer;
         VkShaderModule _module;
         ShaderType _type;
+        uint64_t _id;
 
         void move_common(VulkanShader &&other) noexcept;
 
@@ -44,6 +45,9 @@ namespace giygas {
 
         VkShaderModule module() const;
 
+        // Identifies the shader module for as long as the renderer lives. 0 until code is set.
+        uint64_t id() const;
+
     };
 
 }
@@ -0,0 +1,229 @@
+#include <algorithm>
+#include <cassert>
+#include <limits>
+#include "VulkanStreamBuffer.hpp"
+#include "VulkanRenderer.hpp"
+
+using namespace giygas;
+using namespace std;
+
+// Every frame's region starts at a multiple of this, so offsets aligned within a region are aligned within the buffer.
+// It is also the largest minUniformBufferOffsetAlignment the spec allows.
+static const uint32_t region_alignment = 256;
+
+static uint32_t align_capacity(uint32_t capacity, uint32_t frame_count) {
+    VkDeviceSize alignment_mask = region_alignment - 1;
+    VkDeviceSize aligned = (static_cast<VkDeviceSize>(capacity) + alignment_mask) & ~alignment_mask;
+
+    // Allocation offsets are 32 bit, so the regions of all frames together must fit in 32 bits.
+    assert(aligned * frame_count <= numeric_limits<uint32_t>::max() && "Stream buffer capacity is too large");
+    return static_cast<uint32_t>(aligned);
+}
+
+class StreamBufferSafeDeletable final : public SwapchainSafeDeleteable {
+
+    VkBuffer _handle;
+    VulkanAllocation _allocation;
+
+public:
+
+    StreamBufferSafeDeletable(VkBuffer handle, const VulkanAllocation &allocation) {
+        _handle = handle;
+        _allocation = allocation;
+    }
+
+    void delete_resources(VulkanRenderer &renderer) override {
+        vkDestroyBuffer(renderer.device(), _handle, nullptr);
+        renderer.free_memory(_allocation);
+    }
+
+};
+
+//
+// VulkanStreamVertexBuffer implementation
+//
+
+VulkanStreamVertexBuffer::VulkanStreamVertexBuffer(VkBuffer handle) {
+    _handle = handle;
+}
+
+RendererType VulkanStreamVertexBuffer::renderer_type() const {
+    return RendererType::Vulkan;
+}
+
+void VulkanStreamVertexBuffer::set_data(uint32_t /*offset*/, const uint8_t */*data*/, uint32_t /*size*/) {
+    // Only reachable by casting away the const of StreamBuffer::vertex_buffer().
+    assert(!"Stream buffers are written through StreamBuffer::allocate");
+}
+
+bool VulkanStreamVertexBuffer::is_valid() const {
+    return _handle != VK_NULL_HANDLE;
+}
+
+bool VulkanStreamVertexBuffer::is_writable() const {
+    return false;
+}
+
+VkBuffer VulkanStreamVertexBuffer::handle() const {
+    return _handle;
+}
+
+//
+// VulkanStreamIndexBuffer implementation
+//
+
+VulkanStreamIndexBuffer::VulkanStreamIndexBuffer(VkBuffer handle, VkIndexType index_type) {
+    _handle = handle;
+    _index_type = index_type;
+}
+
+RendererType VulkanStreamIndexBuffer::renderer_type() const {
+    return RendererType::Vulkan;
+}
+
+const void *VulkanStreamIndexBuffer::cast_to_specific() const {
+    return static_cast<const VulkanGenericIndexBuffer *>(this);
+}
+
+VkBuffer VulkanStreamIndexBuffer::handle() const {
+    return _handle;
+}
+
+VkIndexType VulkanStreamIndexBuffer::index_type() const {
+    return _index_type;
+}
+
+//
+// VulkanStreamUniformBuffer implementation
+//
+
+VulkanStreamUniformBuffer::VulkanStreamUniformBuffer(VkBuffer handle, size_t size) {
+    _handle = handle;
+    _size = size;
+}
+
+RendererType VulkanStreamUniformBuffer::renderer_type() const {
+    return RendererType::Vulkan;
+}
+
+const void *VulkanStreamUniformBuffer::cast_to_specific() const {
+    return static_cast<const VulkanGenericUniformBuffer *>(this);
+}
+
+VkBuffer VulkanStreamUniformBuffer::handle() const {
+    return _handle;
+}
+
+size_t VulkanStreamUniformBuffer::size() const {
+    return _size;
+}
+
+VkDeviceSize VulkanStreamUniformBuffer::frame_offset(uint32_t /*frame_index*/) const {
+    return 0;
+}
+
+UniformBufferEventHandler VulkanStreamUniformBuffer::layout_changed() const {
+    // The buffer never changes.
+    return _layout_changed.make_handler();
+}
+
+//
+// VulkanStreamBuffer implementation
+//
+
+VulkanStreamBuffer::VulkanStreamBuffer(VulkanRenderer *renderer, uint32_t capacity)
+    : _renderer(renderer)
+    , _capacity(align_capacity(capacity, renderer->frames_in_flight()))
+    , _handle(create_buffer(renderer, static_cast<VkDeviceSize>(_capacity) * renderer->frames_in_flight(), _allocation))
+    , _vertex_buffer(_handle)
+    , _index_buffer_16(_handle, VK_INDEX_TYPE_UINT16)
+    , _index_buffer_32(_handle, VK_INDEX_TYPE_UINT32)
+    , _uniform_buffer(_handle, static_cast<size_t>(_capacity) * renderer->frames_in_flight())
+{
+}
+
+VulkanStreamBuffer::~VulkanStreamBuffer() {
+    if (_handle == VK_NULL_HANDLE) {
+        return;
+    }
+    _renderer->delete_when_safe(unique_ptr<SwapchainSafeDeleteable>(
+        new StreamBufferSafeDeletable(_handle, _allocation)
+    ));
+}
+
+VkBuffer VulkanStreamBuffer::create_buffer(
+    VulkanRenderer *renderer,
+    VkDeviceSize size,
+    VulkanAllocation &allocation
+) {
+    VkBuffer handle = VK_NULL_HANDLE;
+    renderer->create_buffer(
+        size,
+        VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+        handle,
+        allocation
+    );
+    return handle;
+}
+
+RendererType VulkanStreamBuffer::renderer_type() const {
+    return RendererType::Vulkan;
+}
+
+bool VulkanStreamBuffer::allocate(uint32_t size, uint32_t alignment, StreamAllocation &allocation) {
+    assert(alignment != 0 && (alignment & (alignment - 1)) == 0);
+    if (_allocation.mapped == nullptr) {
+        return false;
+    }
+
+    // The first allocation of a frame takes over the region of the frame slot it will be submitted with. The
+    // renderer waited for that slot's previous submission before making the frame ready, after which nothing reads
+    // the region any more.
+    assert(_renderer->is_frame_ready() && "wait_for_next_frame() must be called before allocating for the next frame");
+    uint64_t serial = _renderer->next_submission_serial();
+    if (serial != _serial) {
+        _serial = serial;
+        _region_offset = _renderer->current_frame_index() * _capacity;
+        _head = 0;
+    }
+
+    uint32_t offset = (_head + alignment - 1) & ~(alignment - 1);
+    if (offset > _capacity || _capacity - offset < size) {
+        return false;
+    }
+    _head = offset + size;
+
+    allocation.offset = _region_offset + offset;
+    allocation.data = _allocation.mapped + allocation.offset;
+    return true;
+}
+
+uint32_t VulkanStreamBuffer::capacity() const {
+    return _capacity;
+}
+
+uint32_t VulkanStreamBuffer::uniform_alignment() const {
+    return max<uint32_t>(static_cast<uint32_t>(_renderer->limits().minUniformBufferOffsetAlignment), 1);
+}
+
+const VertexBuffer *VulkanStreamBuffer::vertex_buffer() const {
+    return &_vertex_buffer;
+}
+
+const GenericIndexBuffer *VulkanStreamBuffer::index_buffer_16() const {
+    return &_index_buffer_16;
+}
+
+const GenericIndexBuffer *VulkanStreamBuffer::index_buffer_32() const {
+    return &_index_buffer_32;
+}
+
+const GenericUniformBuffer *VulkanStreamBuffer::uniform_buffer() const {
+    return &_uniform_buffer;
+}
+
+VkBuffer VulkanStreamBuffer::handle() const {
+    return _handle;
+}
@@ -0,0 +1,138 @@
+#pragma once
+#include <giygas/StreamBuffer.hpp>
+#include <vulkan/vulkan.h>
+#include "VulkanVertexBuffer.hpp"
+#include "VulkanIndexBuffer.hpp"
+#include "VulkanUniformBuffer.hpp"
+#include "VulkanMemoryAllocator.hpp"
+
+namespace giygas {
+
+    class VulkanRenderer;
+
+    // Vertex buffer view of a stream buffer. DrawInfo takes vertex buffers as VertexBuffer, so the view has to be one,
+    // but it is only handed out as const and its set_data() is private.
+    class VulkanStreamVertexBuffer final : public VulkanVertexBuffer {
+
+        VkBuffer _handle = VK_NULL_HANDLE;
+
+        void set_data(uint32_t offset, const uint8_t *data, uint32_t size) override;
+
+    public:
+        explicit VulkanStreamVertexBuffer(VkBuffer handle);
+
+        //
+        // VertexBuffer implementation
+        //
+
+        RendererType renderer_type() const override;
+        bool is_valid() const override;
+        bool is_writable() const override;
+
+        //
+        // VulkanVertexBuffer implementation
+        //
+
+        VkBuffer handle() const override;
+    };
+
+    // Index buffer view of a stream buffer.
+    class VulkanStreamIndexBuffer final : public GenericIndexBuffer, VulkanGenericIndexBuffer {
+
+        VkBuffer _handle = VK_NULL_HANDLE;
+        VkIndexType _index_type = VK_INDEX_TYPE_UINT16;
+
+    public:
+        VulkanStreamIndexBuffer(VkBuffer handle, VkIndexType index_type);
+
+        //
+        // GenericIndexBuffer implementation
+        //
+
+        RendererType renderer_type() const override;
+        const void *cast_to_specific() const override;
+
+        //
+        // VulkanGenericIndexBuffer implementation
+        //
+
+        VkBuffer handle() const override;
+        VkIndexType index_type() const override;
+    };
+
+    // Uniform buffer view of a stream buffer. Allocation offsets already select the frame's region, so every frame
+    // reads from the start of the buffer.
+    class VulkanStreamUniformBuffer final : public GenericUniformBuffer, public VulkanGenericUniformBuffer {
+
+        VkBuffer _handle = VK_NULL_HANDLE;
+        size_t _size = 0;
+        mutable UniformBufferEvent _layout_changed;
+
+    public:
+        VulkanStreamUniformBuffer(VkBuffer handle, size_t size);
+
+        //
+        // GenericUniformBuffer implementation
+        //
+
+        RendererType renderer_type() const override;
+        const void *cast_to_specific() const override;
+
+        //
+        // VulkanGenericUniformBuffer implementation
+        //
+
+        VkBuffer handle() const override;
+        size_t size() const override;
+        VkDeviceSize frame_offset(uint32_t frame_index) const override;
+        UniformBufferEventHandler layout_changed() const override;
+    };
+
+    class VulkanStreamBuffer final : public StreamBuffer {
+
+        VulkanRenderer *_renderer = nullptr;
+        uint32_t _capacity = 0;
+        VulkanAllocation _allocation;
+        VkBuffer _handle = VK_NULL_HANDLE;
+
+        // Serial of the frame the current region belongs to, and where the next allocation starts within it.
+        uint64_t _serial = 0;
+        uint32_t _region_offset = 0;
+        uint32_t _head = 0;
+
+        VulkanStreamVertexBuffer _vertex_buffer;
+        VulkanStreamIndexBuffer _index_buffer_16;
+        VulkanStreamIndexBuffer _index_buffer_32;
+        VulkanStreamUniformBuffer _uniform_buffer;
+
+        static VkBuffer create_buffer(VulkanRenderer *renderer, VkDeviceSize size, VulkanAllocation &allocation);
+
+    public:
+        VulkanStreamBuffer(VulkanRenderer *renderer, uint32_t capacity);
+        VulkanStreamBuffer(const VulkanStreamBuffer &) = delete;
+        VulkanStreamBuffer &operator=(const VulkanStreamBuffer &) = delete;
+        VulkanStreamBuffer(VulkanStreamBuffer &&) noexcept = delete;
+        VulkanStreamBuffer &operator=(VulkanStreamBuffer &&) noexcept = delete;
+        ~VulkanStreamBuffer() override;
+
+        //
+        // StreamBuffer implementation
+        //
+
+        RendererType renderer_type() const override;
+        bool allocate(uint32_t size, uint32_t alignment, StreamAllocation &allocation) override;
+        uint32_t capacity() const override;
+        uint32_t uniform_alignment() const override;
+        const VertexBuffer *vertex_buffer() const override;
+        const GenericIndexBuffer *index_buffer_16() const override;
+        const GenericIndexBuffer *index_buffer_32() const override;
+        const GenericUniformBuffer *uniform_buffer() const override;
+
+        //
+        // VulkanStreamBuffer implementation
+        //
+
+        VkBuffer handle() const;
+    };
+
+}
@@ -11,21 +11,21 @@ class TextureSafeDeletable final : public SwapchainSafeDeleteable {
 
     VkImage _image;
     VkImageView _view;
-    VkDeviceMemory _memory;
+    VulkanAllocation _allocation;
 
 public:
 
-    TextureSafeDeletable(VkImage image, VkImageView view, VkDeviceMemory memory) {
+    TextureSafeDeletable(VkImage image, VkImageView view, const VulkanAllocation &allocation) {
         _image = image;
         _view = view;
-        _memory = memory;
+        _allocation = allocation;
     }
 
     void delete_resources(VulkanRenderer &renderer) override {
         VkDevice device = renderer.device();
         vkDestroyImageView(device, _view, nullptr);
         vkDestroyImage(device, _image, nullptr);
-        vkFreeMemory(device, _memory, nullptr);
+        renderer.free_memory(_allocation);
     }
 
 };
@@ -35,12 +35,14 @@ VulkanTexture::VulkanTexture(VulkanRenderer *renderer) {
     _renderer = renderer;
     _image = VK_NULL_HANDLE;
     _image_view = VK_NULL_HANDLE;
-    _image_memory = VK_NULL_HANDLE;
+    _is_ready = true;
 }
 
 VulkanTexture::~VulkanTexture() {
+    // The background thread may still be creating the texture.
+    wait_until_ready();
     _renderer->delete_when_safe(unique_ptr<SwapchainSafeDeleteable>(
-        new TextureSafeDeletable(_image, _image_view, _image_memory)
+        new TextureSafeDeletable(_image, _image_view, _image_allocation)
     ));
 }
 
@@ -67,9 +69,46 @@ void VulkanTexture::create(
     TextureFormat desired_format,
     TextureUsageFlags usage
 ) {
-    assert(_image == VK_NULL_HANDLE);
+    prepare(move(data), size, width, height, desired_format, usage);
+    finish_create(input_format);
+}
 
-    VkDevice device = _renderer->device();
+void VulkanTexture::create_async(
+    unique_ptr<uint8_t[]> &&data,
+    uint32_t size,
+    uint32_t width,
+    uint32_t height,
+    TextureFormat input_format,
+    TextureFormat desired_format,
+    TextureUsageFlags usage
+) {
+    prepare(move(data), size, width, height, desired_format, usage);
+    _is_ready = false;
+    _renderer->background_tasks().enqueue([this, input_format]() {
+        finish_create(input_format);
+    });
+}
+
+bool VulkanTexture::is_ready() const {
+    lock_guard<mutex> _(_ready_mutex);
+    return _is_ready;
+}
+
+void VulkanTexture::wait_until_ready() const {
+    unique_lock<mutex> lock(_ready_mutex);
+    _ready_condition.wait(lock, [this] { return _is_ready; });
+}
+
+void VulkanTexture::prepare(
+    unique_ptr<uint8_t[]> &&data,
+    uint32_t size,
+    uint32_t width,
+    uint32_t height,
+    TextureFormat desired_format,
+    TextureUsageFlags usage
+) {
+    assert(_image == VK_NULL_HANDLE);
+    assert(_is_ready);
 
     _data = move(data);
     _size = size;
@@ -79,7 +118,6 @@ void VulkanTexture::create(
     // Figure out the desired layout and usage flags
     VkImageLayout final_layout = VK_IMAGE_LAYOUT_UNDEFINED;
     VkImageUsageFlags usage_flags = 0;
-    VkImageTiling tiling = VK_IMAGE_TILING_OPTIMAL;
     if (usage & TEXTURE_USAGE_SAMPLE) {
         final_layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
         usage_flags |= VK_IMAGE_USAGE_SAMPLED_BIT;
@@ -93,6 +131,7 @@ void VulkanTexture::create(
         usage_flags |= VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
     }
     _layout = final_layout;
+    _usage_flags = usage_flags;
 
     VkFormat translated_format = VulkanRenderer::translate_texture_format(desired_format);
     VkFormatFeatureFlags required_features = get_required_format_features(usage_flags);
@@ -104,74 +143,57 @@ void VulkanTexture::create(
         }
     }
 
-    convert_data(input_format, desired_format);
-    size = _size;
     _format = desired_format;
-
     _api_format = translated_format;
+}
 
-    VkImageLayout current_layout = VK_IMAGE_LAYOUT_UNDEFINED;
+void VulkanTexture::finish_create(TextureFormat input_format) {
+    VkDevice device = _renderer->device();
+
+    convert_data(input_format, _format);
+    uint32_t size = _size;
 
+    VkImageLayout current_layout = VK_IMAGE_LAYOUT_UNDEFINED;
+    VkImageUsageFlags usage_flags = _usage_flags;
     if (size > 0) {
         usage_flags |= VK_IMAGE_USAGE_TRANSFER_DST_BIT;
     }
 
     create_image(
-        width,
-        height,
-        translated_format,
-        tiling,
+        _width,
+        _height,
+        _api_format,
+        VK_IMAGE_TILING_OPTIMAL,
         usage_flags,
         VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
         _image,
-        _image_memory,
+        _image_allocation,
         current_layout
     );
 
+    // The upload is recorded along with other pending uploads, and submitted ahead of the next frame. Any frame using
+    // the texture is submitted after that, so the texture is ready as soon as the upload is recorded.
+    VulkanUploadContext &upload_context = _renderer->upload_context();
     if (size > 0) {
-        VkBuffer staging_buffer;
-        VkDeviceMemory staging_buffer_memory;
-
-        _renderer->create_buffer(
+        upload_context.copy_to_image(
+            _data.get(),
             size,
-            VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-            staging_buffer,
-            staging_buffer_memory
-        );
-
-        void *mapped_data;
-        vkMapMemory(device, staging_buffer_memory, 0, size, 0, &mapped_data);
-        copy_n(_data.get(), size, static_cast<uint8_t *>(mapped_data));
-        vkUnmapMemory(device, staging_buffer_memory);
-
-        VkImageLayout next_layout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-        transition_image_layout(
             _image,
-            _format,
-            current_layout,
-            next_layout
+            _width,
+            _height,
+            image_aspects_from_format(_format),
+            _layout
         );
-        current_layout = next_layout;
-
-        copy_buffer_to_image(staging_buffer, _image, width, height);
-
-        vkFreeMemory(device, staging_buffer_memory, nullptr);
-        vkDestroyBuffer(device, staging_buffer, nullptr);
     }
-
-    transition_image_layout(
-        _image,
-        _format,
-        current_layout,
-        final_layout
-    );
+    else {
+        upload_context.transition_image(_image, image_aspects_from_format(_format), current_layout, _layout);
+    }
 
     VkImageViewCreateInfo view_info;
     view_info = {};
     view_info.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
     view_info.viewType = VK_IMAGE_VIEW_TYPE_2D;
-    view_info.format = translated_format;
+    view_info.format = _api_format;
     view_info.components.r = VK_COMPONENT_SWIZZLE_IDENTITY;
     view_info.components.g = VK_COMPONENT_SWIZZLE_IDENTITY;
     view_info.components.b = VK_COMPONENT_SWIZZLE_IDENTITY;
@@ -184,6 +206,12 @@ void VulkanTexture::create(
     view_info.image = _image;
 
     vkCreateImageView(device, &view_info, nullptr, &_image_view);
+
+    {
+        lock_guard<mutex> _(_ready_mutex);
+        _is_ready = true;
+    }
+    _ready_condition.notify_all();
 }
 
 TextureFormat VulkanTexture::format() const {
@@ -231,7 +259,7 @@ void VulkanTexture::create_image(
     VkImageUsageFlags usage_flags,
     VkMemoryPropertyFlags memory_properties,
     VkImage &image,
-    VkDeviceMemory &image_memory,
+    VulkanAllocation &image_allocation,
     VkImageLayout initial_layout
 ) const {
     VkDevice device = _renderer->device();
@@ -254,178 +282,8 @@ void VulkanTexture::create_image(
 
     vkCreateImage(device, &image_create_info, nullptr, &image);
 
-    VkMemoryRequirements memory_requirements;
-    vkGetImageMemoryRequirements(device, image, &memory_requirements);
-
-    VkMemoryAllocateInfo alloc_info = {};
-    alloc_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    alloc_info.allocationSize = memory_requirements.size;
-    if (!_renderer->find_memory_type(
-        memory_requirements.memoryTypeBits,
-        memory_properties,
-        alloc_info.memoryTypeIndex
-    )) {
-        return;
-    }
-
-    vkAllocateMemory(device, &alloc_info, nullptr, &image_memory);
-    vkBindImageMemory(device, image, image_memory, 0);
-}
-
-void VulkanTexture::transition_image_layout(
-    VkImage image,
-    TextureFormat format,
-    VkImageLayout old_layout,
-    VkImageLayout new_layout
-) const {
-    VkCommandBuffer command_buffer = begin_command_buffer();
-
-    VkImageMemoryBarrier barrier = {};
-    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-    barrier.oldLayout = old_layout;
-    barrier.newLayout = new_layout;
-    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-    barrier.image = image;
-    barrier.subresourceRange.aspectMask = image_aspects_from_format(format);
-    barrier.subresourceRange.baseMipLevel = 0;
-    barrier.subresourceRange.levelCount = 1;
-    barrier.subresourceRange.baseArrayLayer = 0;
-    barrier.subresourceRange.layerCount = 1;
-
-    VkPipelineStageFlags source_stage = {};
-    VkPipelineStageFlags dest_stage = {};
-
-    if (old_layout == VK_IMAGE_LAYOUT_UNDEFINED) {
-        barrier.srcAccessMask = 0;
-        source_stage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
-    }
-    else if (old_layout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL) {
-        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-        source_stage = VK_PIPELINE_STAGE_TRANSFER_BIT;
-    }
-    else {
-        // Giygas bug
-        assert(false);
-    }
-
-    if (new_layout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL) {
-        barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-        dest_stage = VK_PIPELINE_STAGE_TRANSFER_BIT;
-    }
-    else if (new_layout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL) {
-        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-        dest_stage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
-    }
-    else if (new_layout == VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL) {
-        barrier.dstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT;
-        dest_stage = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
-    }
-    else if (new_layout == VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL) {
-        barrier.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT;
-        dest_stage = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-    }
-    else {
-        // Giygas bug
-        assert(false);
-    }
-
-    vkCmdPipelineBarrier(
-        command_buffer,
-        source_stage,
-        dest_stage,
-        0,  // dependency flags
-        0,  // memory barrier count
-        nullptr,  // memory barriers
-        0,  // buffer memory barrier count
-        nullptr,  // buffer memory barriers
-        1,  // image memory barrier count
-        &barrier
-    );
-
-    end_command_buffer(command_buffer);
-}
-
-void VulkanTexture::copy_buffer_to_image(
-    VkBuffer buffer,
-    VkImage image,
-    uint32_t width,
-    uint32_t height
-) {
-    VkCommandBuffer command_buffer = begin_command_buffer();
-
-    VkBufferImageCopy region = {};
-    region.bufferOffset = 0;
-    region.bufferRowLength = 0;
-    region.bufferImageHeight = 0;
-
-    region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-    region.imageSubresource.mipLevel = 0;
-    region.imageSubresource.baseArrayLayer = 0;
-    region.imageSubresource.layerCount = 1;
-
-    region.imageOffset = {0, 0, 0};
-    region.imageExtent = {width, height, 1 };
-
-    vkCmdCopyBufferToImage(
-        command_buffer,
-        buffer,
-        image,
-        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-        1,
-        &region
-    );
-
-    end_command_buffer(command_buffer);
-}
-
-VkCommandBuffer VulkanTexture::begin_command_buffer() const {
-    VkCommandPool pool = _renderer->copy_command_pool();
-
-    VkCommandBufferAllocateInfo alloc_info = {};
-    alloc_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-    alloc_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-    alloc_info.commandPool = pool;
-    alloc_info.commandBufferCount = 1;
-
-    VkCommandBuffer command_buffer;
-    vkAllocateCommandBuffers(_renderer->device(), &alloc_info, &command_buffer);
-
-    VkCommandBufferBeginInfo begin_info = {};
-    begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-    begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-
-    vkBeginCommandBuffer(command_buffer, &begin_info);
-    return command_buffer;
-}
-
-void VulkanTexture::end_command_buffer(VkCommandBuffer buffer) const {
-    VkDevice device = _renderer->device();
-    VkCommandPool pool = _renderer->copy_command_pool();
-
-    vkEndCommandBuffer(buffer);
-
-    VkSubmitInfo submit_info = {};
-    submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-    submit_info.commandBufferCount = 1;
-    submit_info.pCommandBuffers = &buffer;
-
-    VkFenceCreateInfo fence_info = {};
-    fence_info.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-    fence_info.flags = 0;
-
-    VkFence fence;
-    vkCreateFence(device, &fence_info, nullptr, &fence);
-
-    vkQueueSubmit(_renderer->graphics_queue(), 1, &submit_info, fence);
-
-    VkResult result = VK_TIMEOUT;
-    while (result == VK_TIMEOUT) {
-        result = vkWaitForFences(device, 1, &fence, VK_FALSE, numeric_limits<uint64_t>::max());
-    }
-
-    vkDestroyFence(device, fence, nullptr);
-    vkFreeCommandBuffers(_renderer->device(), pool, 1, &buffer);
+    assert(tiling == VK_IMAGE_TILING_OPTIMAL);
+    _renderer->create_image_memory(image, memory_properties, image_allocation);
 }
 
 VkImageAspectFlags VulkanTexture::image_aspects_from_format(TextureFormat format) {
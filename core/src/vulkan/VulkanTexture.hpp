@@ -1,8 +1,11 @@
 #pragma once
 #include <giygas/Texture.hpp>
 #include <vulkan/vulkan.h>
+#include <condition_variable>
 #include <memory>
+#include <mutex>
 #include "VulkanRenderTarget.hpp"
+#include "VulkanMemoryAllocator.hpp"
 
 namespace giygas {
     class VulkanRenderer;
@@ -12,7 +15,7 @@ namespace giygas {
         VulkanRenderer *_renderer;
         VkImage _image;
         VkImageView _image_view;
-        VkDeviceMemory _image_memory;
+        VulkanAllocation _image_allocation;
         std::unique_ptr<uint8_t[]> _data;
         uint32_t _size;
         uint32_t _width;
@@ -20,6 +23,21 @@ namespace giygas {
         TextureFormat _format;
         VkFormat _api_format;
         VkImageLayout _layout;
+        VkImageUsageFlags _usage_flags;
+
+        mutable std::mutex _ready_mutex;
+        mutable std::condition_variable _ready_condition;
+        bool _is_ready;
+
+        void prepare(
+            std::unique_ptr<uint8_t[]> &&data,
+            uint32_t size,
+            uint32_t width,
+            uint32_t height,
+            TextureFormat desired_format,
+            TextureUsageFlags usage
+        );
+        void finish_create(TextureFormat input_format);
 
         void create_image(
             uint32_t width,
@@ -29,27 +47,10 @@ namespace giygas {
             VkImageUsageFlags usage_flags,
             VkMemoryPropertyFlags memory_properties,
             VkImage &image,
-            VkDeviceMemory &image_memory,
+            VulkanAllocation &image_allocation,
             VkImageLayout initial_layout
         ) const;
 
-        void transition_image_layout(
-            VkImage image,
-            TextureFormat format,
-            VkImageLayout old_layout,
-            VkImageLayout new_layout
-        ) const;
-
-        void copy_buffer_to_image(
-            VkBuffer buffer,
-            VkImage image,
-            uint32_t width,
-            uint32_t height
-        );
-
-        VkCommandBuffer begin_command_buffer() const;
-        void end_command_buffer(VkCommandBuffer buffer) const;
-
         VkFormatFeatureFlags get_required_format_features(VkImageUsageFlags usage_flags) const;
         bool supports_texture_format(VkFormat format, VkFormatFeatureFlags needed_features) const;
 
@@ -81,6 +82,19 @@ namespace giygas {
             TextureUsageFlags flags
         ) override;
 
+        void create_async(
+            std::unique_ptr<uint8_t[]> &&data,
+            uint32_t size,
+            uint32_t width,
+            uint32_t height,
+            TextureFormat input_format,
+            TextureFormat desired_format,
+            TextureUsageFlags flags
+        ) override;
+
+        bool is_ready() const override;
+        void wait_until_ready() const override;
+
         TextureFormat format() const override;
         const void *texture_impl() const override;
 
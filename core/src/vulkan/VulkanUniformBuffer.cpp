@@ -1,4 +1,5 @@
 #include <algorithm>
+#include <cassert>
 #include "VulkanUniformBuffer.hpp"
 #include "VulkanRenderer.hpp"
 
@@ -7,19 +8,18 @@ using namespace giygas;
 class UniformBufferSafeDeletable final : public SwapchainSafeDeleteable {
 
     VkBuffer _handle;
-    VkDeviceMemory _device_memory;
+    VulkanAllocation _allocation;
 
 public:
 
-    UniformBufferSafeDeletable(VkBuffer handle, VkDeviceMemory device_memory) {
+    UniformBufferSafeDeletable(VkBuffer handle, const VulkanAllocation &allocation) {
         _handle = handle;
-        _device_memory = device_memory;
+        _allocation = allocation;
     }
 
     void delete_resources(VulkanRenderer &renderer) override {
-        VkDevice device = renderer.device();
-        vkFreeMemory(device, _device_memory, nullptr);
-        vkDestroyBuffer(device, _handle, nullptr);
+        vkDestroyBuffer(renderer.device(), _handle, nullptr);
+        renderer.free_memory(_allocation);
     }
 
 };
@@ -27,17 +27,16 @@ public:
 VulkanUniformBuffer::VulkanUniformBuffer(VulkanRenderer *renderer) {
     _renderer = renderer;
     _handle = VK_NULL_HANDLE;
-    _device_memory = VK_NULL_HANDLE;
-    _mapped_buffer = nullptr;
+    _slice_stride = 0;
+
+    // Slices start out at version 0, which never holds contents.
+    _version = 1;
 }
 
 VulkanUniformBuffer::~VulkanUniformBuffer() {
-    if (_device_memory != VK_NULL_HANDLE) {
-        vkUnmapMemory(_renderer->device(), _device_memory);
-    }
-
+    _renderer->cancel_frame_updates(this);
     _renderer->delete_when_safe(unique_ptr<SwapchainSafeDeleteable>(
-        new UniformBufferSafeDeletable(_handle, _device_memory)
+        new UniformBufferSafeDeletable(_handle, _allocation)
     ));
 }
 
@@ -45,41 +44,95 @@ RendererType VulkanUniformBuffer::renderer_type() const {
     return RendererType::Vulkan;
 }
 
+const void *VulkanUniformBuffer::cast_to_specific() const {
+    return static_cast<const VulkanGenericUniformBuffer *>(this);
+}
+
 void VulkanUniformBuffer::set_data(uint32_t offset, const uint8_t *data, uint32_t size) {
-    VkDevice device = _renderer->device();
-    size_t required_size = offset + size;
-    bool needs_new_buffer = _data.size() < required_size;
+    // The data belongs to the next submitted frame. Once the renderer has waited for that frame's previous
+    // submission, nothing reads its slice.
+    assert(_renderer->is_frame_ready() && "wait_for_next_frame() must be called before writing the next frame");
+    uint32_t frame_index = _renderer->current_frame_index();
 
-    if (needs_new_buffer) {
-        size_t previous_size = _data.size();
+    size_t required_size = offset + size;
+    bool is_resized = _data.size() < required_size;
+    if (is_resized) {
         _data.resize(required_size);
-        if (_device_memory != VK_NULL_HANDLE) {
-            vkUnmapMemory(device, _device_memory);
-        }
-        vkFreeMemory(device, _device_memory, nullptr);
-        vkDestroyBuffer(device, _handle, nullptr);
-        _renderer->create_buffer(
-            static_cast<VkDeviceSize>(required_size),
-            VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
-            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-            _handle,
-            _device_memory
-        );
-
-        vkMapMemory(device, _device_memory, offset, size, 0, &_mapped_buffer);
-
-        if (_mapped_buffer != nullptr) {
-            copy_n(_data.data(), previous_size, static_cast<uint8_t *>(_mapped_buffer));
+        if (_slice_stride < required_size) {
+            grow(required_size);
         }
     }
-
     copy_n(data, size, _data.data() + offset);
 
-    if (_mapped_buffer == nullptr) {
+    uint64_t previous_version = _version++;
+    if (_allocation.mapped == nullptr) {
         // TODO: Should probably warn about this?
         return;
     }
-    copy_n(data, size, static_cast<uint8_t *>(_mapped_buffer));
+
+    // A slice which missed earlier writes gets the whole contents.
+    uint8_t *slice = _allocation.mapped + frame_offset(frame_index);
+    if (_slice_versions[frame_index] == previous_version) {
+        copy_n(data, size, slice + offset);
+    } else {
+        copy_n(_data.data(), _data.size(), slice);
+    }
+    _slice_versions[frame_index] = _version;
+
+    if (is_resized && _layout_changed.has_handlers()) {
+        const VulkanGenericUniformBuffer *self = this;
+        _layout_changed.invoke(self);
+    }
+    if (!is_up_to_date()) {
+        _renderer->update_when_frames_available(this);
+    }
+}
+
+void VulkanUniformBuffer::grow(size_t required_size) {
+    if (_handle != VK_NULL_HANDLE) {
+        _renderer->delete_when_safe(unique_ptr<SwapchainSafeDeleteable>(
+            new UniformBufferSafeDeletable(_handle, _allocation)
+        ));
+    }
+
+    // Slices start at multiples of minUniformBufferOffsetAlignment, so each can be bound at its offset.
+    VkDeviceSize alignment = max<VkDeviceSize>(_renderer->limits().minUniformBufferOffsetAlignment, 1);
+    _slice_stride = (static_cast<VkDeviceSize>(required_size) + alignment - 1) / alignment * alignment;
+
+    uint32_t frame_count = _renderer->frames_in_flight();
+    _slice_versions = unique_ptr<uint64_t[]>(new uint64_t[frame_count]);
+    fill_n(_slice_versions.get(), frame_count, 0);
+
+    _handle = VK_NULL_HANDLE;
+    _allocation = {};
+    _renderer->create_buffer(
+        _slice_stride * frame_count,
+        VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+        _handle,
+        _allocation
+    );
+}
+
+bool VulkanUniformBuffer::is_up_to_date() const {
+    for (uint32_t i = 0, ilen = _renderer->frames_in_flight(); i < ilen; ++i) {
+        if (_slice_versions[i] != _version) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool VulkanUniformBuffer::update_frame(uint32_t frame_index) {
+    if (_allocation.mapped == nullptr) {
+        return true;
+    }
+    if (_slice_versions[frame_index] != _version) {
+        copy_n(_data.data(), _data.size(), _allocation.mapped + frame_offset(frame_index));
+        _slice_versions[frame_index] = _version;
+    }
+    return is_up_to_date();
 }
 
 VkBuffer VulkanUniformBuffer::handle() const {
@@ -89,3 +142,11 @@ VkBuffer VulkanUniformBuffer::handle() const {
 size_t VulkanUniformBuffer::size() const {
     return _data.size();
 }
+
+VkDeviceSize VulkanUniformBuffer::frame_offset(uint32_t frame_index) const {
+    return _slice_stride * frame_index;
+}
+
+UniformBufferEventHandler VulkanUniformBuffer::layout_changed() const {
+    return _layout_changed.make_handler();
+}
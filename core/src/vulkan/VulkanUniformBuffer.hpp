@@ -1,23 +1,66 @@
 #pragma once
 #include <giygas/UniformBuffer.hpp>
+#include <giygas/EventHandler.hpp>
 #include <vulkan/vulkan.h>
+#include <memory>
 #include <vector>
+#include "VulkanMemoryAllocator.hpp"
+#include "VulkanFrameResource.hpp"
 
 namespace giygas {
     using namespace std;
 
     class VulkanRenderer;
+    class VulkanGenericUniformBuffer;
 
-    class VulkanUniformBuffer final : public UniformBuffer {
+    typedef Event<const VulkanGenericUniformBuffer *> UniformBufferEvent;
+    typedef EventHandler<const VulkanGenericUniformBuffer *> UniformBufferEventHandler;
+
+    // What descriptors need to know about a uniform buffer. GenericUniformBuffer::cast_to_specific() returns this.
+    class VulkanGenericUniformBuffer {
+    public:
+        virtual ~VulkanGenericUniformBuffer() = default;
+
+        virtual VkBuffer handle() const = 0;
+        virtual size_t size() const = 0;
+
+        // Byte offset of the data the frame reads within the buffer.
+        virtual VkDeviceSize frame_offset(uint32_t frame_index) const = 0;
+
+        // Invoked when the handle or size changes, after which descriptors referring to the buffer must be rewritten.
+        virtual UniformBufferEventHandler layout_changed() const = 0;
+    };
+
+    // Uniform data with one slice of a persistently mapped buffer per frame in flight. Writes go to the slice of the
+    // frame being recorded, which no submitted frame reads, and reach the other slices as their frames become
+    // available.
+    class VulkanUniformBuffer final
+        : public UniformBuffer
+        , public VulkanGenericUniformBuffer
+        , public VulkanFrameResource
+    {
 
         VulkanRenderer *_renderer;
         VkBuffer _handle;
-        VkDeviceMemory _device_memory;
+        VulkanAllocation _allocation;
+        VkDeviceSize _slice_stride;
         vector<uint8_t> _data;
-        void *_mapped_buffer;
+
+        // Contents version held by each slice.
+        uint64_t _version;
+        unique_ptr<uint64_t[]> _slice_versions;
+
+        mutable UniformBufferEvent _layout_changed;
+
+        void grow(size_t required_size);
+        bool is_up_to_date() const;
 
     public:
         explicit VulkanUniformBuffer(VulkanRenderer *renderer);
+        VulkanUniformBuffer(const VulkanUniformBuffer &) = delete;
+        VulkanUniformBuffer &operator=(const VulkanUniformBuffer &) = delete;
+        VulkanUniformBuffer(VulkanUniformBuffer &&) noexcept = delete;
+        VulkanUniformBuffer &operator=(VulkanUniformBuffer &&) noexcept = delete;
         ~VulkanUniformBuffer() override;
 
         //
@@ -25,15 +68,23 @@ namespace giygas {
         //
 
         RendererType renderer_type() const override;
+        const void *cast_to_specific() const override;
         void set_data(uint32_t offset, const uint8_t *data, uint32_t size) override;
 
+        //
+        // VulkanFrameResource implementation
+        //
+
+        bool update_frame(uint32_t frame_index) override;
 
         //
-        // VulkanUniformBuffer implementation
+        // VulkanGenericUniformBuffer implementation
         //
 
-        VkBuffer handle() const;
-        size_t size() const;
+        VkBuffer handle() const override;
+        size_t size() const override;
+        VkDeviceSize frame_offset(uint32_t frame_index) const override;
+        UniformBufferEventHandler layout_changed() const override;
     };
 
 }
@@ -0,0 +1,582 @@
+#include <cassert>
+#include <cstring>
+#include <limits>
+#include "VulkanUploadContext.hpp"
+#include "VulkanRenderer.hpp"
+
+using namespace giygas;
+using namespace std;
+
+// Satisfies the buffer offset alignment of vkCmdCopyBufferToImage for every texel size giygas uses.
+static const VkDeviceSize staging_alignment = 16;
+
+static const uint64_t unsubmitted_serial = numeric_limits<uint64_t>::max();
+
+VulkanUploadContext::~VulkanUploadContext() {
+    destroy();
+}
+
+void VulkanUploadContext::create(VulkanRenderer *renderer, VkDeviceSize staging_capacity) {
+    _renderer = renderer;
+    const QueueFamilyIndices &queue_family_indices = renderer->queue_family_indices();
+    _graphics.pool.create(
+        renderer,
+        queue_family_indices.graphics_family,
+        VK_COMMAND_POOL_CREATE_TRANSIENT_BIT | VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT
+    );
+    _has_transfer_queue = queue_family_indices.has_transfer_family();
+    if (_has_transfer_queue) {
+        _transfer.pool.create(
+            renderer,
+            queue_family_indices.transfer_family,
+            VK_COMMAND_POOL_CREATE_TRANSIENT_BIT | VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT
+        );
+    }
+    create_staging_buffer(staging_capacity);
+}
+
+void VulkanUploadContext::destroy() {
+    if (_renderer == nullptr) {
+        return;
+    }
+
+    VkDevice device = _renderer->device();
+
+    // Command buffers are freed along with their pools.
+    CommandBuffers *all_command_buffers[] = {&_graphics, &_transfer};
+    for (CommandBuffers *command_buffers : all_command_buffers) {
+        command_buffers->pool.destroy();
+        command_buffers->submitted.clear();
+        command_buffers->free.clear();
+        command_buffers->recording = VK_NULL_HANDLE;
+    }
+    _buffer_ownership_barriers.clear();
+    _image_ownership_barriers.clear();
+
+    for (const PendingSemaphore &semaphore : _submitted_semaphores) {
+        vkDestroySemaphore(device, semaphore.handle, nullptr);
+    }
+    for (VkSemaphore semaphore : _free_semaphores) {
+        vkDestroySemaphore(device, semaphore, nullptr);
+    }
+    _submitted_semaphores.clear();
+    _free_semaphores.clear();
+
+    for (const RetiredStagingBuffer &retired : _retired_staging_buffers) {
+        vkDestroyBuffer(device, retired.buffer, nullptr);
+        _renderer->free_memory(retired.allocation);
+    }
+    _retired_staging_buffers.clear();
+
+    vkDestroyBuffer(device, _staging_buffer, nullptr);
+    _renderer->free_memory(_staging_allocation);
+    _staging_buffer = VK_NULL_HANDLE;
+    _staging_allocation = {};
+
+    _renderer = nullptr;
+}
+
+void VulkanUploadContext::copy_to_buffer(
+    const void *data,
+    VkDeviceSize size,
+    VkBuffer destination,
+    VkDeviceSize offset
+) {
+    if (size == 0) {
+        return;
+    }
+
+    lock_guard<mutex> _(_mutex);
+    VkCommandBuffer command_buffer = begin_staging_copy(0);
+
+    VkBufferCopy region = {};
+    region.srcOffset = stage(data, size);
+    region.dstOffset = offset;
+    region.size = size;
+    vkCmdCopyBuffer(command_buffer, _staging_buffer, destination, 1, &region);
+
+    if (!_has_transfer_queue) {
+        _has_buffer_copies = true;
+        return;
+    }
+
+    const QueueFamilyIndices &queue_family_indices = _renderer->queue_family_indices();
+    VkBufferMemoryBarrier barrier = {};
+    barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    barrier.srcQueueFamilyIndex = queue_family_indices.transfer_family;
+    barrier.dstQueueFamilyIndex = queue_family_indices.graphics_family;
+    barrier.buffer = destination;
+    barrier.offset = offset;
+    barrier.size = size;
+    _buffer_ownership_barriers.push_back(barrier);
+}
+
+void VulkanUploadContext::copy_to_image(
+    const void *data,
+    VkDeviceSize size,
+    VkImage image,
+    uint32_t width,
+    uint32_t height,
+    VkImageAspectFlags aspects,
+    VkImageLayout final_layout
+) {
+    lock_guard<mutex> _(_mutex);
+    VkCommandBuffer command_buffer = begin_staging_copy(aspects);
+
+    VkBufferImageCopy region = {};
+    region.bufferOffset = stage(data, size);
+    region.bufferRowLength = 0;
+    region.bufferImageHeight = 0;
+    region.imageSubresource.aspectMask = aspects;
+    region.imageSubresource.mipLevel = 0;
+    region.imageSubresource.baseArrayLayer = 0;
+    region.imageSubresource.layerCount = 1;
+    region.imageOffset = {0, 0, 0};
+    region.imageExtent = {width, height, 1};
+
+    record_image_barrier(
+        command_buffer,
+        image,
+        aspects,
+        VK_IMAGE_LAYOUT_UNDEFINED,
+        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL
+    );
+    vkCmdCopyBufferToImage(
+        command_buffer,
+        _staging_buffer,
+        image,
+        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+        1,
+        &region
+    );
+
+    if (command_buffer != _transfer.recording) {
+        record_image_barrier(command_buffer, image, aspects, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, final_layout);
+        return;
+    }
+
+    // The layout transition happens as part of the ownership transfer, and must be identical on both queues.
+    const QueueFamilyIndices &queue_family_indices = _renderer->queue_family_indices();
+    VkImageMemoryBarrier barrier = {};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.newLayout = final_layout;
+    barrier.srcQueueFamilyIndex = queue_family_indices.transfer_family;
+    barrier.dstQueueFamilyIndex = queue_family_indices.graphics_family;
+    barrier.image = image;
+    barrier.subresourceRange.aspectMask = aspects;
+    barrier.subresourceRange.baseMipLevel = 0;
+    barrier.subresourceRange.levelCount = 1;
+    barrier.subresourceRange.baseArrayLayer = 0;
+    barrier.subresourceRange.layerCount = 1;
+    _image_ownership_barriers.push_back(barrier);
+}
+
+void VulkanUploadContext::transition_image(
+    VkImage image,
+    VkImageAspectFlags aspects,
+    VkImageLayout old_layout,
+    VkImageLayout new_layout
+) {
+    lock_guard<mutex> _(_mutex);
+    record_image_barrier(begin_recording(_graphics), image, aspects, old_layout, new_layout);
+}
+
+VkCommandBuffer VulkanUploadContext::take_pending(uint64_t serial, VkSemaphore &wait_semaphore) {
+    lock_guard<mutex> _(_mutex);
+    return end_recording(serial, wait_semaphore);
+}
+
+void VulkanUploadContext::flush() {
+    // The mutex only guards the recording state. The graphics queue is externally synchronized with submit(), which is
+    // why this may only be called from the thread submitting frames.
+    lock_guard<mutex> _(_mutex);
+
+    // The graphics queue executes in order, and waits for the transfer queue, so the uploads are complete once the
+    // next frame submitted after them is.
+    VkSemaphore wait_semaphore = VK_NULL_HANDLE;
+    VkCommandBuffer command_buffer = end_recording(_renderer->next_submission_serial(), wait_semaphore);
+    if (command_buffer == VK_NULL_HANDLE) {
+        return;
+    }
+
+    VkPipelineStageFlags wait_stage = VK_PIPELINE_STAGE_TRANSFER_BIT;
+    VkSubmitInfo submit_info = {};
+    submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submit_info.waitSemaphoreCount = wait_semaphore == VK_NULL_HANDLE ? 0 : 1;
+    submit_info.pWaitSemaphores = &wait_semaphore;
+    submit_info.pWaitDstStageMask = &wait_stage;
+    submit_info.commandBufferCount = 1;
+    submit_info.pCommandBuffers = &command_buffer;
+    vkQueueSubmit(_renderer->graphics_queue(), 1, &submit_info, VK_NULL_HANDLE);
+}
+
+VkCommandBuffer VulkanUploadContext::begin_staging_copy(VkImageAspectFlags aspects) {
+    // Queues without graphics support cannot copy to depth or stencil aspects.
+    bool is_transferable = (aspects & ~VK_IMAGE_ASPECT_COLOR_BIT) == 0;
+    return begin_recording(_has_transfer_queue && is_transferable ? _transfer : _graphics);
+}
+
+VkCommandBuffer VulkanUploadContext::begin_recording(CommandBuffers &command_buffers) {
+    if (command_buffers.recording != VK_NULL_HANDLE) {
+        return command_buffers.recording;
+    }
+
+    release_completed();
+
+    VkCommandBuffer command_buffer = VK_NULL_HANDLE;
+    if (!command_buffers.free.empty()) {
+        command_buffer = command_buffers.free.back();
+        command_buffers.free.pop_back();
+        vkResetCommandBuffer(command_buffer, 0);
+    }
+    else {
+        VkCommandBufferAllocateInfo alloc_info = {};
+        alloc_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        alloc_info.commandPool = command_buffers.pool.handle();
+        alloc_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        alloc_info.commandBufferCount = 1;
+        vkAllocateCommandBuffers(_renderer->device(), &alloc_info, &command_buffer);
+    }
+
+    VkCommandBufferBeginInfo begin_info = {};
+    begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    vkBeginCommandBuffer(command_buffer, &begin_info);
+
+    command_buffers.recording = command_buffer;
+    return command_buffer;
+}
+
+VkCommandBuffer VulkanUploadContext::end_transfer_recording(uint64_t serial, VkSemaphore &signal_semaphore) {
+    VkCommandBuffer command_buffer = _transfer.recording;
+
+    // Release the uploaded resources to the graphics queue family. The matching acquire provides visibility, so there
+    // is nothing to make available to the rest of the transfer queue.
+    for (VkBufferMemoryBarrier &barrier : _buffer_ownership_barriers) {
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = 0;
+    }
+    for (VkImageMemoryBarrier &barrier : _image_ownership_barriers) {
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = 0;
+    }
+    vkCmdPipelineBarrier(
+        command_buffer,
+        VK_PIPELINE_STAGE_TRANSFER_BIT,
+        VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+        0,
+        0,
+        nullptr,
+        static_cast<uint32_t>(_buffer_ownership_barriers.size()),
+        _buffer_ownership_barriers.data(),
+        static_cast<uint32_t>(_image_ownership_barriers.size()),
+        _image_ownership_barriers.data()
+    );
+
+    vkEndCommandBuffer(command_buffer);
+    _transfer.recording = VK_NULL_HANDLE;
+    _transfer.submitted.push_back({serial, command_buffer});
+
+    signal_semaphore = VK_NULL_HANDLE;
+    if (!_free_semaphores.empty()) {
+        signal_semaphore = _free_semaphores.back();
+        _free_semaphores.pop_back();
+    }
+    else {
+        VkSemaphoreCreateInfo semaphore_info = {};
+        semaphore_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+        vkCreateSemaphore(_renderer->device(), &semaphore_info, nullptr, &signal_semaphore);
+    }
+    _submitted_semaphores.push_back({serial, signal_semaphore});
+
+    return command_buffer;
+}
+
+VkCommandBuffer VulkanUploadContext::end_recording(uint64_t serial, VkSemaphore &wait_semaphore) {
+    wait_semaphore = VK_NULL_HANDLE;
+
+    if (_transfer.recording != VK_NULL_HANDLE) {
+        VkCommandBuffer transfer_command_buffer = end_transfer_recording(serial, wait_semaphore);
+
+        VkSubmitInfo submit_info = {};
+        submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submit_info.commandBufferCount = 1;
+        submit_info.pCommandBuffers = &transfer_command_buffer;
+        submit_info.signalSemaphoreCount = 1;
+        submit_info.pSignalSemaphores = &wait_semaphore;
+        vkQueueSubmit(_renderer->transfer_queue(), 1, &submit_info, VK_NULL_HANDLE);
+
+        // Acquire the released resources. The semaphore is waited on at the transfer stage, which these barriers
+        // chain from.
+        for (VkBufferMemoryBarrier &barrier : _buffer_ownership_barriers) {
+            barrier.srcAccessMask = 0;
+            barrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_INDEX_READ_BIT
+                | VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_UNIFORM_READ_BIT | VK_ACCESS_SHADER_READ_BIT;
+        }
+        VkPipelineStageFlags dest_stages = _buffer_ownership_barriers.empty() ? 0
+            : VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT
+                | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+        for (VkImageMemoryBarrier &barrier : _image_ownership_barriers) {
+            VkPipelineStageFlags dest_stage = 0;
+            barrier.srcAccessMask = 0;
+            get_layout_access(barrier.newLayout, barrier.dstAccessMask, dest_stage);
+            dest_stages |= dest_stage;
+        }
+        vkCmdPipelineBarrier(
+            begin_recording(_graphics),
+            VK_PIPELINE_STAGE_TRANSFER_BIT,
+            dest_stages,
+            0,
+            0,
+            nullptr,
+            static_cast<uint32_t>(_buffer_ownership_barriers.size()),
+            _buffer_ownership_barriers.data(),
+            static_cast<uint32_t>(_image_ownership_barriers.size()),
+            _image_ownership_barriers.data()
+        );
+        _buffer_ownership_barriers.clear();
+        _image_ownership_barriers.clear();
+    }
+
+    VkCommandBuffer command_buffer = _graphics.recording;
+    if (command_buffer == VK_NULL_HANDLE) {
+        return VK_NULL_HANDLE;
+    }
+
+    // One barrier makes all buffer copies of the batch visible to the frame's draws.
+    if (_has_buffer_copies) {
+        VkMemoryBarrier barrier = {};
+        barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_INDEX_READ_BIT
+            | VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_UNIFORM_READ_BIT | VK_ACCESS_SHADER_READ_BIT;
+        vkCmdPipelineBarrier(
+            command_buffer,
+            VK_PIPELINE_STAGE_TRANSFER_BIT,
+            VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT
+                | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+            0,
+            1,
+            &barrier,
+            0,
+            nullptr,
+            0,
+            nullptr
+        );
+        _has_buffer_copies = false;
+    }
+
+    vkEndCommandBuffer(command_buffer);
+    _graphics.recording = VK_NULL_HANDLE;
+    _graphics.submitted.push_back({serial, command_buffer});
+
+    if (_staging_unmarked > 0) {
+        _staging_markers.push_back({serial, _staging_head, _staging_unmarked});
+        _staging_unmarked = 0;
+    }
+    for (RetiredStagingBuffer &retired : _retired_staging_buffers) {
+        if (retired.serial == unsubmitted_serial) {
+            retired.serial = serial;
+        }
+    }
+
+    return command_buffer;
+}
+
+void VulkanUploadContext::release_completed() {
+    uint64_t completed_serial = _renderer->completed_frame_serial();
+
+    // The frames wait on the transfer submissions, so both complete along with the frame serial.
+    release_completed(_graphics, completed_serial);
+    release_completed(_transfer, completed_serial);
+
+    while (!_submitted_semaphores.empty() && _submitted_semaphores.front().serial <= completed_serial) {
+        _free_semaphores.push_back(_submitted_semaphores.front().handle);
+        _submitted_semaphores.pop_front();
+    }
+
+    while (!_staging_markers.empty() && _staging_markers.front().serial <= completed_serial) {
+        _staging_tail = _staging_markers.front().head;
+        _staging_used -= _staging_markers.front().size;
+        _staging_markers.pop_front();
+    }
+
+    VkDevice device = _renderer->device();
+    for (size_t i = 0; i < _retired_staging_buffers.size();) {
+        const RetiredStagingBuffer &retired = _retired_staging_buffers[i];
+        if (retired.serial <= completed_serial) {
+            vkDestroyBuffer(device, retired.buffer, nullptr);
+            _renderer->free_memory(retired.allocation);
+            _retired_staging_buffers.erase(_retired_staging_buffers.begin() + i);
+        }
+        else {
+            ++i;
+        }
+    }
+}
+
+void VulkanUploadContext::release_completed(CommandBuffers &command_buffers, uint64_t completed_serial) {
+    while (!command_buffers.submitted.empty() && command_buffers.submitted.front().serial <= completed_serial) {
+        command_buffers.free.push_back(command_buffers.submitted.front().handle);
+        command_buffers.submitted.pop_front();
+    }
+}
+
+bool VulkanUploadContext::allocate_staging(VkDeviceSize size, VkDeviceSize &offset) {
+    if (_staging_used == 0) {
+        _staging_head = 0;
+        _staging_tail = 0;
+    }
+
+    VkDeviceSize start = (_staging_head + staging_alignment - 1) / staging_alignment * staging_alignment;
+
+    // Free space is either everything after the head plus everything before the tail, or the gap between a wrapped
+    // head and the tail.
+    if (_staging_head > _staging_tail || _staging_used == 0) {
+        if (start + size <= _staging_capacity) {
+            _staging_used += start + size - _staging_head;
+            _staging_unmarked += start + size - _staging_head;
+            _staging_head = start + size;
+            offset = start;
+            return true;
+        }
+        if (size <= _staging_tail) {
+            _staging_used += _staging_capacity - _staging_head + size;
+            _staging_unmarked += _staging_capacity - _staging_head + size;
+            _staging_head = size;
+            offset = 0;
+            return true;
+        }
+        return false;
+    }
+
+    if (start + size <= _staging_tail) {
+        _staging_used += start + size - _staging_head;
+        _staging_unmarked += start + size - _staging_head;
+        _staging_head = start + size;
+        offset = start;
+        return true;
+    }
+    return false;
+}
+
+bool VulkanUploadContext::create_staging_buffer(VkDeviceSize capacity) {
+    VkBuffer buffer = VK_NULL_HANDLE;
+    VulkanAllocation allocation;
+    _renderer->create_buffer(
+        capacity,
+        VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+        0,
+        buffer,
+        allocation
+    );
+
+    if (allocation.mapped == nullptr) {
+        vkDestroyBuffer(_renderer->device(), buffer, nullptr);
+        _renderer->free_memory(allocation);
+        return false;
+    }
+
+    // The old buffer may still be read by submitted or pending uploads, which all complete along with the pending
+    // command buffer. Its serial is filled in once that is known, since this may run on any thread.
+    if (_staging_buffer != VK_NULL_HANDLE) {
+        _retired_staging_buffers.push_back({unsubmitted_serial, _staging_buffer, _staging_allocation});
+    }
+
+    _staging_buffer = buffer;
+    _staging_allocation = allocation;
+    _staging_capacity = capacity;
+    _staging_head = 0;
+    _staging_tail = 0;
+    _staging_used = 0;
+    _staging_unmarked = 0;
+    _staging_markers.clear();
+    return true;
+}
+
+VkDeviceSize VulkanUploadContext::stage(const void *data, VkDeviceSize size) {
+    VkDeviceSize offset = 0;
+    if (!allocate_staging(size, offset)) {
+        release_completed();
+        if (!allocate_staging(size, offset)) {
+            bool created = create_staging_buffer(max(_staging_capacity * 2, size + staging_alignment));
+            assert(created);
+            allocate_staging(size, offset);
+        }
+    }
+
+    memcpy(_staging_allocation.mapped + offset, data, static_cast<size_t>(size));
+    return offset;
+}
+
+void VulkanUploadContext::get_layout_access(
+    VkImageLayout layout,
+    VkAccessFlags &access,
+    VkPipelineStageFlags &stage
+) {
+    if (layout == VK_IMAGE_LAYOUT_UNDEFINED) {
+        access = 0;
+        stage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+    }
+    else if (layout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL) {
+        access = VK_ACCESS_TRANSFER_WRITE_BIT;
+        stage = VK_PIPELINE_STAGE_TRANSFER_BIT;
+    }
+    else if (layout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL) {
+        access = VK_ACCESS_SHADER_READ_BIT;
+        stage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+    }
+    else if (layout == VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL) {
+        access = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT;
+        stage = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
+    }
+    else if (layout == VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL) {
+        access = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT;
+        stage = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    }
+    else {
+        // Giygas bug
+        assert(false);
+    }
+}
+
+void VulkanUploadContext::record_image_barrier(
+    VkCommandBuffer command_buffer,
+    VkImage image,
+    VkImageAspectFlags aspects,
+    VkImageLayout old_layout,
+    VkImageLayout new_layout
+) {
+    VkImageMemoryBarrier barrier = {};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.oldLayout = old_layout;
+    barrier.newLayout = new_layout;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = image;
+    barrier.subresourceRange.aspectMask = aspects;
+    barrier.subresourceRange.baseMipLevel = 0;
+    barrier.subresourceRange.levelCount = 1;
+    barrier.subresourceRange.baseArrayLayer = 0;
+    barrier.subresourceRange.layerCount = 1;
+
+    VkPipelineStageFlags source_stage = {};
+    VkPipelineStageFlags dest_stage = {};
+    get_layout_access(old_layout, barrier.srcAccessMask, source_stage);
+    get_layout_access(new_layout, barrier.dstAccessMask, dest_stage);
+
+    vkCmdPipelineBarrier(
+        command_buffer,
+        source_stage,
+        dest_stage,
+        0,  // dependency flags
+        0,  // memory barrier count
+        nullptr,  // memory barriers
+        0,  // buffer memory barrier count
+        nullptr,  // buffer memory barriers
+        1,  // image memory barrier count
+        &barrier
+    );
+}
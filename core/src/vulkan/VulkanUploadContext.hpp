@@ -0,0 +1,140 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include <deque>
+#include <mutex>
+#include <vector>
+#include "VulkanCommandPool.hpp"
+#include "VulkanMemoryAllocator.hpp"
+
+namespace giygas {
+
+    class VulkanRenderer;
+
+    // Gathers buffer and image uploads, along with their layout transitions, into a single command buffer which is
+    // submitted ahead of the next frame, or by flush(). Data is staged through a persistently mapped ring buffer whose
+    // regions are recycled once the frame serial they were submitted with has completed.
+    //
+    // When the device has a queue family without graphics support, copies from the staging buffer are recorded for
+    // that family's queue instead, so they overlap rendering. Ownership of the uploaded resources is then released by
+    // the transfer command buffer and acquired by the graphics one, which waits on a semaphore the transfer submission
+    // signals.
+    class VulkanUploadContext final {
+
+        class StagingMarker {
+        public:
+            uint64_t serial;
+            VkDeviceSize head;
+            VkDeviceSize size;
+        };
+
+        class RetiredStagingBuffer {
+        public:
+            uint64_t serial;
+            VkBuffer buffer;
+            VulkanAllocation allocation;
+        };
+
+        class PendingCommandBuffer {
+        public:
+            uint64_t serial;
+            VkCommandBuffer handle;
+        };
+
+        class PendingSemaphore {
+        public:
+            uint64_t serial;
+            VkSemaphore handle;
+        };
+
+        class CommandBuffers {
+        public:
+            VulkanCommandPool pool;
+            std::deque<PendingCommandBuffer> submitted;
+            std::vector<VkCommandBuffer> free;
+            VkCommandBuffer recording = VK_NULL_HANDLE;
+        };
+
+        VulkanRenderer *_renderer = nullptr;
+        std::mutex _mutex;
+
+        CommandBuffers _graphics;
+        bool _has_buffer_copies = false;
+
+        // Only used with a dedicated transfer queue.
+        bool _has_transfer_queue = false;
+        CommandBuffers _transfer;
+        std::vector<VkBufferMemoryBarrier> _buffer_ownership_barriers;
+        std::vector<VkImageMemoryBarrier> _image_ownership_barriers;
+        std::deque<PendingSemaphore> _submitted_semaphores;
+        std::vector<VkSemaphore> _free_semaphores;
+
+        VkBuffer _staging_buffer = VK_NULL_HANDLE;
+        VulkanAllocation _staging_allocation;
+        VkDeviceSize _staging_capacity = 0;
+        VkDeviceSize _staging_head = 0;
+        VkDeviceSize _staging_tail = 0;
+        VkDeviceSize _staging_used = 0;
+        VkDeviceSize _staging_unmarked = 0;
+        std::deque<StagingMarker> _staging_markers;
+        std::vector<RetiredStagingBuffer> _retired_staging_buffers;
+
+        VkCommandBuffer begin_recording(CommandBuffers &command_buffers);
+        VkCommandBuffer begin_staging_copy(VkImageAspectFlags aspects);
+        void release_completed();
+        void release_completed(CommandBuffers &command_buffers, uint64_t completed_serial);
+        bool allocate_staging(VkDeviceSize size, VkDeviceSize &offset);
+        bool create_staging_buffer(VkDeviceSize capacity);
+        VkDeviceSize stage(const void *data, VkDeviceSize size);
+        VkCommandBuffer end_recording(uint64_t serial, VkSemaphore &wait_semaphore);
+        VkCommandBuffer end_transfer_recording(uint64_t serial, VkSemaphore &signal_semaphore);
+
+        static void get_layout_access(VkImageLayout layout, VkAccessFlags &access, VkPipelineStageFlags &stage);
+        static void record_image_barrier(
+            VkCommandBuffer command_buffer,
+            VkImage image,
+            VkImageAspectFlags aspects,
+            VkImageLayout old_layout,
+            VkImageLayout new_layout
+        );
+
+    public:
+        VulkanUploadContext() = default;
+        VulkanUploadContext(const VulkanUploadContext &) = delete;
+        VulkanUploadContext &operator=(const VulkanUploadContext &) = delete;
+        VulkanUploadContext(VulkanUploadContext &&) noexcept = delete;
+        VulkanUploadContext &operator=(VulkanUploadContext &&) noexcept = delete;
+        ~VulkanUploadContext();
+
+        void create(VulkanRenderer *renderer, VkDeviceSize staging_capacity);
+        void destroy();
+
+        void copy_to_buffer(const void *data, VkDeviceSize size, VkBuffer destination, VkDeviceSize offset);
+
+        void copy_to_image(
+            const void *data,
+            VkDeviceSize size,
+            VkImage image,
+            uint32_t width,
+            uint32_t height,
+            VkImageAspectFlags aspects,
+            VkImageLayout final_layout
+        );
+        void transition_image(
+            VkImage image,
+            VkImageAspectFlags aspects,
+            VkImageLayout old_layout,
+            VkImageLayout new_layout
+        );
+
+        // Ends the pending command buffer, to be submitted with the frame of the given serial. Returns VK_NULL_HANDLE
+        // when there is nothing to upload. Any copies recorded for the transfer queue are submitted here, and
+        // wait_semaphore is set to the semaphore the frame must wait on at VK_PIPELINE_STAGE_TRANSFER_BIT, or
+        // VK_NULL_HANDLE.
+        VkCommandBuffer take_pending(uint64_t serial, VkSemaphore &wait_semaphore);
+
+        // Submits the pending command buffer on its own. Uses the graphics queue, so it must be called from the thread
+        // submitting frames.
+        void flush();
+    };
+
+}
@@ -36,6 +36,11 @@ VkBuffer VulkanVertexBufferImpl<T>::handle() const {
     return _buffer.handle();
 }
 
+template <typename T>
+T &VulkanVertexBufferImpl<T>::buffer() {
+    return _buffer;
+}
+
 namespace giygas {
     template class VulkanVertexBufferImpl<ReadOnlyVertexBuffer>;
     template class VulkanVertexBufferImpl<WritableVertexBuffer>;
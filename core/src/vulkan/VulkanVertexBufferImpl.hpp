@@ -43,6 +43,12 @@ namespace giygas {
 
         VkBuffer handle() const override;
 
+        //
+        // VulkanVertexBufferImpl implementation
+        //
+
+        T &buffer();
+
     };
 
     extern template class VulkanVertexBufferImpl<ReadOnlyVertexBuffer>;
@@ -1,3 +1,4 @@
+#include <cassert>
 #include <algorithm>
 #include "WritableBuffer.hpp"
 #include "VulkanRenderer.hpp"
@@ -16,28 +17,23 @@ namespace giygas {
     class InUseBufferSafeDeletable final : public SwapchainSafeDeleteable {
 
         SafeDeletableEvent _event;
-        VkBuffer _buffer = VK_NULL_HANDLE;
-        VkDeviceMemory _memory = VK_NULL_HANDLE;
-        uint32_t _size = 0;
+        WritableBufferInstance _instance;
 
     public:
 
         InUseBufferSafeDeletable(InUseBufferSafeDeletable &&) = default;
         InUseBufferSafeDeletable &operator=(InUseBufferSafeDeletable &&) = default;
 
-        InUseBufferSafeDeletable(VkBuffer buffer, VkDeviceMemory memory, uint32_t size) {
-            _buffer = buffer;
-            _memory = memory;
-            _size = size;
+        explicit InUseBufferSafeDeletable(const WritableBufferInstance &instance) {
+            _instance = instance;
         }
 
         void delete_resources(VulkanRenderer &renderer) override {
             if (_event.has_handlers()) {
                 _event.invoke(this);
             } else {
-                VkDevice device = renderer.device();
-                vkFreeMemory(device, _memory, nullptr);
-                vkDestroyBuffer(device, _buffer, nullptr);
+                vkDestroyBuffer(renderer.device(), _instance.buffer, nullptr);
+                renderer.free_memory(_instance.allocation);
             }
         }
 
@@ -45,16 +41,8 @@ namespace giygas {
             return _event.make_handler();
         }
 
-        VkBuffer buffer() const {
-            return _buffer;
-        }
-
-        VkDeviceMemory memory() const {
-            return _memory;
-        }
-
-        uint32_t size() const {
-            return _size;
+        const WritableBufferInstance &instance() const {
+            return _instance;
         }
 
     };
@@ -67,113 +55,153 @@ TEMPLATE CLASS::WritableBuffer(VulkanRenderer *renderer) {
 }
 
 TEMPLATE CLASS::~WritableBuffer() {
-    _renderer->delete_when_safe(unique_ptr<SwapchainSafeDeleteable>(
-        new InUseBufferSafeDeletable(_handle, _device_memory, 0)
-    ));
+    _renderer->delete_when_safe(unique_ptr<SwapchainSafeDeleteable>(new InUseBufferSafeDeletable(_current)));
     { lock_guard<mutex> _(_available_buffers_mutex);
-        for (tuple<VkBuffer, VkDeviceMemory, uint32_t> buffer_memory_and_size : _available_buffers) {
-            _renderer->delete_when_safe(unique_ptr<SwapchainSafeDeleteable>(
-                new InUseBufferSafeDeletable(
-                    get<0>(buffer_memory_and_size)
-                    , get<1>(buffer_memory_and_size)
-                    , 0)
-            ));
+        for (const WritableBufferInstance &instance : _available_buffers) {
+            _renderer->delete_when_safe(unique_ptr<SwapchainSafeDeleteable>(new InUseBufferSafeDeletable(instance)));
         }
         _event_handlers.clear();
     }
 }
 
+TEMPLATE
+void CLASS::disable_shadow_copy() {
+    assert(_version == 0 && "The shadow copy must be disabled before the first set_data()");
+    _has_shadow_copy = false;
+}
+
 TEMPLATE
 void CLASS::set_data(uint32_t offset, const uint8_t *data, uint32_t size) {
-    uint32_t previous_size = _data.size();
-    uint32_t required_size = size + offset;
-    if (previous_size < required_size) {
-        _data.resize(required_size);
+    uint32_t previous_size = _size;
+    uint32_t required_size = max(previous_size, offset + size);
+    if (_has_shadow_copy) {
+        if (_data.size() < required_size) {
+            _data.resize(required_size);
+        }
+        copy_n(data, size, _data.begin() + offset);
     }
-    copy_n(data, size, _data.begin() + offset);
 
+    // Without a shadow copy, the previous instance is the only place holding the current contents. It stays alive
+    // until the frames using it are complete, so it can be read from here.
+    WritableBufferInstance previous = _current;
+    const uint8_t *source = _has_shadow_copy ? _data.data() : previous.allocation.mapped;
 
-    VkDevice device = _renderer->device();
-    VkDeviceSize buffer_size = static_cast<VkDeviceSize>(required_size);
-    if (buffer_size == 0) {
-        buffer_size = 1;
+    retire_current();
+    WritableBufferInstance instance = acquire_instance(required_size);
+    if (source != nullptr) {
+        bring_up_to_date(instance, source, previous_size);
     }
 
-    VkBuffer buffer = _handle;
-    VkDeviceMemory memory = _device_memory;
+    ++_version;
+    _updates.push_back({_version, offset, size});
+    if (_updates.size() > max_logged_updates) {
+        _updates.pop_front();
+    }
 
-    { lock_guard<mutex> _(_available_buffers_mutex);
+    if (size > 0 && instance.allocation.mapped != nullptr) {
+        copy_n(data, size, instance.allocation.mapped + offset);
+    }
+    instance.version = _version;
+    _size = required_size;
 
-        if (buffer != VK_NULL_HANDLE) {
-            // Return current buffer that might be in use
-            auto *in_use_deletable = new InUseBufferSafeDeletable(buffer, memory, _current_buffer_size);
-            auto no_longer_in_use_handler = in_use_deletable->resources_no_longer_in_use();
-            no_longer_in_use_handler.delegate = BIND_MEMBER1(&WritableBuffer::handle_buffer_no_longer_in_use);
-            _event_handlers.emplace(
-                piecewise_construct
-                , forward_as_tuple(in_use_deletable)
-                , forward_as_tuple(move(no_longer_in_use_handler))
-            );
-            _renderer->delete_when_safe(unique_ptr<SwapchainSafeDeleteable>(in_use_deletable));
-            buffer = VK_NULL_HANDLE;
-            memory = VK_NULL_HANDLE;
-        }
+    { lock_guard<mutex> _(_handle_mutex);
+        _current = instance;
+    }
+}
 
+TEMPLATE
+void CLASS::retire_current() {
+    if (_current.buffer == VK_NULL_HANDLE) {
+        return;
+    }
+
+    // Return current buffer that might be in use
+    lock_guard<mutex> _(_available_buffers_mutex);
+    auto *in_use_deletable = new InUseBufferSafeDeletable(_current);
+    auto no_longer_in_use_handler = in_use_deletable->resources_no_longer_in_use();
+    no_longer_in_use_handler.delegate = BIND_MEMBER1(&WritableBuffer::handle_buffer_no_longer_in_use);
+    _event_handlers.emplace(
+        piecewise_construct
+        , forward_as_tuple(in_use_deletable)
+        , forward_as_tuple(move(no_longer_in_use_handler))
+    );
+    _renderer->delete_when_safe(unique_ptr<SwapchainSafeDeleteable>(in_use_deletable));
+}
+
+TEMPLATE
+WritableBufferInstance CLASS::acquire_instance(uint32_t required_size) {
+    { lock_guard<mutex> _(_available_buffers_mutex);
         while (!_available_buffers.empty()) {
-            tuple<VkBuffer, VkDeviceMemory, uint32_t> buffer_memory_and_size =  _available_buffers.back();
+            WritableBufferInstance instance = _available_buffers.back();
             _available_buffers.pop_back();
-            if (get<2>(buffer_memory_and_size) < required_size) {
+            if (instance.size < required_size) {
                 // This buffer isn't big enough. Delete it.
-                vkDestroyBuffer(device, get<0>(buffer_memory_and_size), nullptr);
-                vkFreeMemory(device, get<1>(buffer_memory_and_size), nullptr);
+                vkDestroyBuffer(_renderer->device(), instance.buffer, nullptr);
+                _renderer->free_memory(instance.allocation);
                 continue;
             }
-            buffer = get<0>(buffer_memory_and_size);
-            memory = get<1>(buffer_memory_and_size);
-            _current_buffer_size = get<2>(buffer_memory_and_size);
-            break;
+            return instance;
         }
     }
 
-    if (buffer == VK_NULL_HANDLE) {
-        // Need to create a new buffer
-        // TODO: Less copy + paste
-        _renderer->create_buffer(
-            buffer_size
-            , USAGE_FLAGS  /* usage */
-            , VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT  /* memory_properties */
-            , buffer
-            , memory
-        );
-        _current_buffer_size = required_size;
+    // Need to create a new buffer
+    WritableBufferInstance instance;
+    VkDeviceSize buffer_size = static_cast<VkDeviceSize>(required_size);
+    if (buffer_size == 0) {
+        buffer_size = 1;
     }
+    // Instances are only written by the CPU, so device local host visible memory (resizable BAR) saves the GPU reads
+    // over the bus. Without the shadow copy, instances are also read back, which wants cached memory instead.
+    _renderer->create_buffer(
+        buffer_size
+        , USAGE_FLAGS  /* usage */
+        , VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT  /* required_memory_properties */
+        , _has_shadow_copy
+            ? VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
+            : VK_MEMORY_PROPERTY_HOST_CACHED_BIT  /* preferred_memory_properties */
+        , instance.buffer
+        , instance.allocation
+    );
+    instance.size = required_size;
+    return instance;
+}
 
-    // Vulkan does not support memory mappings of 0 bytes.
-    if (size > 0) {
-        void *mapped_buffer;
-        if (vkMapMemory(device, memory, 0, required_size, 0, &mapped_buffer) != VK_SUCCESS) {
-            return;
-        }
-        std::copy_n(_data.data(), required_size, static_cast<uint8_t *>(mapped_buffer));
-        vkUnmapMemory(device, memory);
+TEMPLATE
+void CLASS::bring_up_to_date(
+    WritableBufferInstance &instance,
+    const uint8_t *source,
+    uint32_t source_size
+) const {
+    uint8_t *destination = instance.allocation.mapped;
+    if (destination == nullptr || instance.version == _version) {
+        return;
     }
 
-    { lock_guard<mutex> _(_handle_mutex);
-        _handle = buffer;
-        _device_memory = memory;
+    // Copy only the updates the instance missed, as long as all of them are still logged.
+    bool has_missed_updates_logged = instance.version > 0
+        && !_updates.empty()
+        && _updates.front().version <= instance.version + 1;
+    if (!has_missed_updates_logged) {
+        copy_n(source, source_size, destination);
+        return;
     }
 
+    for (const Update &update : _updates) {
+        if (update.version > instance.version) {
+            copy_n(source + update.offset, update.size, destination + update.offset);
+        }
+    }
 }
 
 TEMPLATE
 bool CLASS::is_valid() const {
-    return _handle != VK_NULL_HANDLE;
+    return _current.buffer != VK_NULL_HANDLE;
 }
 
 TEMPLATE
 VkBuffer CLASS::handle() const {
     lock_guard<mutex> _(_handle_mutex);
-    return _handle;
+    return _current.buffer;
 }
 
 TEMPLATE
@@ -184,11 +212,12 @@ void CLASS::handle_buffer_no_longer_in_use(InUseBufferSafeDeletable *deletable)
             _event_handlers.erase(it);
         }
 
-        _available_buffers.emplace_back(make_tuple(deletable->buffer(), deletable->memory(), deletable->size()));
+        _available_buffers.push_back(deletable->instance());
     }
 }
 
 namespace giygas {
     template class WritableBuffer<VK_BUFFER_USAGE_VERTEX_BUFFER_BIT>;
     template class WritableBuffer<VK_BUFFER_USAGE_INDEX_BUFFER_BIT>;
+    template class WritableBuffer<VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT>;
 }
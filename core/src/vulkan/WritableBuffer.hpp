@@ -1,11 +1,12 @@
 #pragma once
 #include <giygas/EventHandler.hpp>
 #include <vulkan/vulkan.h>
+#include <deque>
 #include <memory>
 #include <unordered_map>
 #include <vector>
-#include <tuple>
 #include <mutex>
+#include "VulkanMemoryAllocator.hpp"
 
 namespace giygas {
 
@@ -15,21 +16,51 @@ namespace giygas {
     typedef Event<InUseBufferSafeDeletable *> SafeDeletableEvent;
     typedef EventHandler<InUseBufferSafeDeletable *> SafeDeletableEventHandler;
 
+    // One of the persistently mapped buffers a WritableBuffer cycles through. It holds the buffer's contents as of
+    // the given version.
+    class WritableBufferInstance {
+    public:
+        VkBuffer buffer = VK_NULL_HANDLE;
+        VulkanAllocation allocation;
+        uint32_t size = 0;
+        uint64_t version = 0;
+    };
 
+    // A buffer whose contents may change every frame. Since earlier frames may still read the buffer, every
+    // set_data() moves to a different instance, recycled once the frames using it are complete. Only the range being
+    // written, plus any ranges a recycled instance missed while it was in use, are copied.
     template <VkBufferUsageFlags USAGE_FLAGS>
     class WritableBuffer final {
 
+        class Update {
+        public:
+            uint64_t version;
+            uint32_t offset;
+            uint32_t size;
+        };
+
         VulkanRenderer *_renderer = nullptr;
-        VkBuffer _handle = VK_NULL_HANDLE;
-        VkDeviceMemory _device_memory = VK_NULL_HANDLE;
+        WritableBufferInstance _current;
+        mutable std::mutex _handle_mutex;
+
+        // With the shadow copy, missing ranges are copied from system memory rather than read back from the mapped
+        // memory of the previous instance, which is usually uncached.
+        bool _has_shadow_copy = true;
         std::vector<uint8_t> _data;
-        uint32_t _current_buffer_size = 0;
+        uint32_t _size = 0;
+
+        uint64_t _version = 0;
+        std::deque<Update> _updates;
+        static const size_t max_logged_updates = 64;
+
         std::unordered_map<InUseBufferSafeDeletable *, SafeDeletableEventHandler> _event_handlers;
-        std::vector<std::tuple<VkBuffer, VkDeviceMemory, uint32_t>> _available_buffers;
+        std::vector<WritableBufferInstance> _available_buffers;
         std::mutex _available_buffers_mutex;
-        mutable std::mutex _handle_mutex;
 
         void handle_buffer_no_longer_in_use(InUseBufferSafeDeletable *deletable);
+        void retire_current();
+        WritableBufferInstance acquire_instance(uint32_t required_size);
+        void bring_up_to_date(WritableBufferInstance &instance, const uint8_t *source, uint32_t source_size) const;
 
     public:
         explicit WritableBuffer(VulkanRenderer *renderer);
@@ -39,6 +70,9 @@ namespace giygas {
         WritableBuffer &operator=(WritableBuffer &&) noexcept = delete;
         ~WritableBuffer();
 
+        // Drops the system memory copy of the contents. Must be called before the first set_data().
+        void disable_shadow_copy();
+
         void set_data(uint32_t offset, const uint8_t *data, uint32_t size);
         bool is_valid() const;
 
@@ -48,5 +82,6 @@ namespace giygas {
 
     typedef WritableBuffer<VK_BUFFER_USAGE_VERTEX_BUFFER_BIT> WritableVertexBuffer;
     typedef WritableBuffer<VK_BUFFER_USAGE_INDEX_BUFFER_BIT>  WritableIndexBuffer;
+    typedef WritableBuffer<VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT> WritableIndirectBuffer;
 
 }
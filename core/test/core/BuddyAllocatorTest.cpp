@@ -0,0 +1,68 @@
+#include <gtest/gtest.h>
+#include <BuddyAllocator.hpp>
+#include <vector>
+
+using namespace giygas;
+
+TEST(BuddyAllocatorTest, RegionsAreAlignedToTheirSize) {
+    BuddyAllocator allocator(1024, 16);
+
+    uint64_t small_offset = 0;
+    uint64_t large_offset = 0;
+    ASSERT_TRUE(allocator.allocate(10, 1, small_offset));
+    ASSERT_TRUE(allocator.allocate(100, 1, large_offset));
+
+    EXPECT_EQ(allocator.region_size(10, 1), 16u);
+    EXPECT_EQ(allocator.region_size(100, 1), 128u);
+    EXPECT_EQ(small_offset % 16, 0u);
+    EXPECT_EQ(large_offset % 128, 0u);
+    EXPECT_EQ(allocator.used(), 144u);
+}
+
+TEST(BuddyAllocatorTest, AlignmentLargerThanSizeGrowsTheRegion) {
+    BuddyAllocator allocator(1024, 16);
+
+    uint64_t first = 0;
+    uint64_t second = 0;
+    ASSERT_TRUE(allocator.allocate(16, 1, first));
+    ASSERT_TRUE(allocator.allocate(16, 256, second));
+
+    EXPECT_EQ(allocator.region_size(16, 256), 256u);
+    EXPECT_EQ(second % 256, 0u);
+    EXPECT_NE(first, second);
+}
+
+TEST(BuddyAllocatorTest, FailsWhenFull) {
+    BuddyAllocator allocator(256, 64);
+
+    uint64_t offset = 0;
+    for (int i = 0; i < 4; ++i) {
+        ASSERT_TRUE(allocator.allocate(64, 1, offset));
+    }
+    EXPECT_FALSE(allocator.allocate(1, 1, offset));
+    EXPECT_FALSE(allocator.allocate(512, 1, offset));
+}
+
+TEST(BuddyAllocatorTest, FreedBuddiesMergeBackIntoWholeRange) {
+    BuddyAllocator allocator(1024, 16);
+
+    std::vector<uint64_t> offsets;
+    uint64_t offset = 0;
+    while (allocator.allocate(16, 1, offset)) {
+        offsets.push_back(offset);
+    }
+    ASSERT_EQ(offsets.size(), 64u);
+
+    // Free in an order that leaves no buddy pairs until the very end.
+    for (size_t i = 0; i < offsets.size(); i += 2) {
+        allocator.free(offsets[i], 16, 1);
+    }
+    EXPECT_FALSE(allocator.allocate(32, 1, offset));
+    for (size_t i = 1; i < offsets.size(); i += 2) {
+        allocator.free(offsets[i], 16, 1);
+    }
+
+    EXPECT_TRUE(allocator.is_empty());
+    ASSERT_TRUE(allocator.allocate(1024, 1, offset));
+    EXPECT_EQ(offset, 0u);
+}
@@ -0,0 +1,58 @@
+#include <gtest/gtest.h>
+#include <LinearArena.hpp>
+
+using namespace giygas;
+
+// A frame's worth of mixed size allocations: one block up front, then two small arrays per item. Returns the first
+// allocation.
+static void *allocate_frame(LinearArena &arena, size_t item_count) {
+    void *first = arena.allocate(3 * 16, 8);
+    for (size_t i = 0; i < item_count; ++i) {
+        uint64_t *buffers = arena.allocate_array<uint64_t>(2);
+        uint64_t *offsets = arena.allocate_array<uint64_t>(2);
+        buffers[0] = buffers[1] = i;
+        offsets[0] = offsets[1] = 0;
+    }
+    return first;
+}
+
+TEST(LinearArenaTest, ReturnsAlignedNonOverlappingMemory) {
+    LinearArena arena(64);
+
+    auto *a = static_cast<uint8_t *>(arena.allocate(3, 1));
+    auto *b = static_cast<uint8_t *>(arena.allocate(8, 8));
+    auto *c = static_cast<uint8_t *>(arena.allocate(16, 16));
+
+    EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(b) % 8);
+    EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(c) % 16);
+    EXPECT_GE(b, a + 3);
+    EXPECT_GE(c, b + 8);
+}
+
+TEST(LinearArenaTest, GrowsToFitUsageOnReset) {
+    LinearArena arena(64);
+
+    allocate_frame(arena, 1000);
+    arena.reset();
+
+    EXPECT_GE(arena.capacity(), 1000 * 4 * sizeof(uint64_t));
+}
+
+TEST(LinearArenaTest, SteadyStateUsageStaysInOneBlock) {
+    LinearArena arena;
+
+    // Warm up, letting the arena grow to the size of a frame.
+    allocate_frame(arena, 20000);
+    arena.reset();
+
+    // The arena only allocates for overflow blocks, which reset() would fold into a larger block. An unchanged
+    // capacity and base address mean every frame fit in the block allocated by the first reset.
+    size_t capacity = arena.capacity();
+    void *base = allocate_frame(arena, 20000);
+    arena.reset();
+    for (int frame = 0; frame < 10; ++frame) {
+        EXPECT_EQ(base, allocate_frame(arena, 20000));
+        arena.reset();
+        EXPECT_EQ(capacity, arena.capacity());
+    }
+}
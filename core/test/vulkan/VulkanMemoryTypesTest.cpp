@@ -0,0 +1,141 @@
+#include <gtest/gtest.h>
+#include <vulkan/VulkanMemoryTypes.hpp>
+
+using namespace giygas;
+
+static const VkDeviceSize mebibyte = 1024 * 1024;
+
+static const VkMemoryPropertyFlags device_local = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+static const VkMemoryPropertyFlags host_visible = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT
+    | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+static const VkMemoryPropertyFlags host_cached = VK_MEMORY_PROPERTY_HOST_CACHED_BIT;
+
+static void add_heap(VkPhysicalDeviceMemoryProperties &properties, VkDeviceSize size, VkMemoryHeapFlags flags) {
+    VkMemoryHeap &heap = properties.memoryHeaps[properties.memoryHeapCount++];
+    heap.size = size;
+    heap.flags = flags;
+}
+
+static void add_type(VkPhysicalDeviceMemoryProperties &properties, uint32_t heap, VkMemoryPropertyFlags flags) {
+    VkMemoryType &type = properties.memoryTypes[properties.memoryTypeCount++];
+    type.heapIndex = heap;
+    type.propertyFlags = flags;
+}
+
+// A discrete GPU with resizable BAR: video memory, system memory, and all of video memory host visible.
+static VkPhysicalDeviceMemoryProperties make_discrete_properties() {
+    VkPhysicalDeviceMemoryProperties properties = {};
+    add_heap(properties, 8192 * mebibyte, VK_MEMORY_HEAP_DEVICE_LOCAL_BIT);
+    add_heap(properties, 16384 * mebibyte, 0);
+    add_type(properties, 0, device_local);
+    add_type(properties, 1, host_visible);
+    add_type(properties, 1, host_visible | host_cached);
+    add_type(properties, 0, device_local | host_visible);
+    return properties;
+}
+
+static VulkanMemoryRequest make_request(VkMemoryPropertyFlags required, VkMemoryPropertyFlags preferred) {
+    VulkanMemoryRequest request;
+    request.required = required;
+    request.preferred = preferred;
+    return request;
+}
+
+TEST(VulkanMemoryTypesTest, RequiresEveryRequiredFlag) {
+    VkPhysicalDeviceMemoryProperties properties = {};
+    add_heap(properties, 256 * mebibyte, VK_MEMORY_HEAP_DEVICE_LOCAL_BIT);
+    add_type(properties, 0, device_local);
+    add_type(properties, 0, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
+
+    uint32_t memory_type = 0;
+    EXPECT_FALSE(choose_memory_type(properties, nullptr, ~0u, make_request(host_visible, 0), 0, memory_type));
+}
+
+TEST(VulkanMemoryTypesTest, RespectsTypeFilter) {
+    VkPhysicalDeviceMemoryProperties properties = make_discrete_properties();
+
+    uint32_t memory_type = 0;
+    ASSERT_TRUE(choose_memory_type(properties, nullptr, 1u << 3, make_request(device_local, 0), 0, memory_type));
+    EXPECT_EQ(memory_type, 3u);
+}
+
+TEST(VulkanMemoryTypesTest, DynamicBuffersPreferDeviceLocalHostVisible) {
+    VkPhysicalDeviceMemoryProperties properties = make_discrete_properties();
+
+    uint32_t memory_type = 0;
+    ASSERT_TRUE(choose_memory_type(
+        properties, nullptr, ~0u, make_request(host_visible, device_local), 0, memory_type
+    ));
+    EXPECT_EQ(memory_type, 3u);
+}
+
+TEST(VulkanMemoryTypesTest, ReadbacksPreferHostCached) {
+    VkPhysicalDeviceMemoryProperties properties = make_discrete_properties();
+
+    uint32_t memory_type = 0;
+    ASSERT_TRUE(choose_memory_type(
+        properties, nullptr, ~0u, make_request(host_visible, host_cached), 0, memory_type
+    ));
+    EXPECT_EQ(memory_type, 2u);
+}
+
+TEST(VulkanMemoryTypesTest, AvoidsFlagsThatWereNotAskedFor) {
+    VkPhysicalDeviceMemoryProperties properties = make_discrete_properties();
+
+    // Staging memory should not take up host visible video memory, nor should static resources.
+    uint32_t memory_type = 0;
+    ASSERT_TRUE(choose_memory_type(properties, nullptr, ~0u, make_request(host_visible, 0), 0, memory_type));
+    EXPECT_EQ(memory_type, 1u);
+    ASSERT_TRUE(choose_memory_type(properties, nullptr, ~0u, make_request(device_local, 0), 0, memory_type));
+    EXPECT_EQ(memory_type, 0u);
+}
+
+TEST(VulkanMemoryTypesTest, NeverPicksUnrequestedLazilyAllocatedMemory) {
+    VkPhysicalDeviceMemoryProperties properties = {};
+    add_heap(properties, 256 * mebibyte, VK_MEMORY_HEAP_DEVICE_LOCAL_BIT);
+    add_type(properties, 0, device_local | VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT);
+
+    uint32_t memory_type = 0;
+    EXPECT_FALSE(choose_memory_type(properties, nullptr, ~0u, make_request(device_local, 0), 0, memory_type));
+    EXPECT_TRUE(choose_memory_type(
+        properties, nullptr, ~0u,
+        make_request(device_local | VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT, 0), 0, memory_type
+    ));
+}
+
+TEST(VulkanMemoryTypesTest, FallsBackWhenPreferredHeapIsOverBudget) {
+    // Without resizable BAR, only a 256 MiB window of video memory is host visible.
+    VkPhysicalDeviceMemoryProperties properties = {};
+    add_heap(properties, 8192 * mebibyte, VK_MEMORY_HEAP_DEVICE_LOCAL_BIT);
+    add_heap(properties, 16384 * mebibyte, 0);
+    add_heap(properties, 256 * mebibyte, VK_MEMORY_HEAP_DEVICE_LOCAL_BIT);
+    add_type(properties, 0, device_local);
+    add_type(properties, 1, host_visible);
+    add_type(properties, 2, device_local | host_visible);
+
+    VkDeviceSize heap_usage[VK_MAX_MEMORY_HEAPS] = {};
+    VulkanMemoryRequest request = make_request(host_visible, device_local);
+
+    uint32_t memory_type = 0;
+    ASSERT_TRUE(choose_memory_type(properties, heap_usage, ~0u, request, 64 * mebibyte, memory_type));
+    EXPECT_EQ(memory_type, 2u);
+
+    heap_usage[2] = 192 * mebibyte;
+    ASSERT_TRUE(choose_memory_type(properties, heap_usage, ~0u, request, 64 * mebibyte, memory_type));
+    EXPECT_EQ(memory_type, 1u);
+}
+
+TEST(VulkanMemoryTypesTest, UsesOverBudgetHeapWhenNothingElseFits) {
+    VkPhysicalDeviceMemoryProperties properties = {};
+    add_heap(properties, 256 * mebibyte, VK_MEMORY_HEAP_DEVICE_LOCAL_BIT);
+    add_type(properties, 0, device_local);
+
+    VkDeviceSize heap_usage[VK_MAX_MEMORY_HEAPS] = {};
+    heap_usage[0] = 250 * mebibyte;
+
+    uint32_t memory_type = 1;
+    ASSERT_TRUE(choose_memory_type(
+        properties, heap_usage, ~0u, make_request(device_local, 0), 4 * mebibyte, memory_type
+    ));
+    EXPECT_EQ(memory_type, 0u);
+}
@@ -0,0 +1,105 @@
+#include <gtest/gtest.h>
+#include <cstring>
+#include <vulkan/VulkanPipelineCache.hpp>
+
+using namespace giygas;
+using namespace std;
+
+static VkPhysicalDeviceProperties make_device_properties() {
+    VkPhysicalDeviceProperties properties = {};
+    properties.vendorID = 0x10de;
+    properties.deviceID = 0x2484;
+    properties.driverVersion = 0x81a5c000;
+    for (uint32_t i = 0; i < VK_UUID_SIZE; ++i) {
+        properties.pipelineCacheUUID[i] = static_cast<uint8_t>(i * 7 + 1);
+    }
+    return properties;
+}
+
+// Cache data as the driver returns it: the Vulkan header followed by the driver's own contents.
+static vector<uint8_t> make_cache_data(const VkPhysicalDeviceProperties &properties, size_t contents_size) {
+    uint32_t header[4] = {
+        16 + VK_UUID_SIZE,
+        VK_PIPELINE_CACHE_HEADER_VERSION_ONE,
+        properties.vendorID,
+        properties.deviceID
+    };
+    vector<uint8_t> data(sizeof(header) + VK_UUID_SIZE + contents_size, 0xab);
+    memcpy(data.data(), header, sizeof(header));
+    memcpy(data.data() + sizeof(header), properties.pipelineCacheUUID, VK_UUID_SIZE);
+    return data;
+}
+
+static bool read_header(const vector<uint8_t> &file, const VkPhysicalDeviceProperties &properties) {
+    size_t data_offset = 0;
+    size_t data_size = 0;
+    return VulkanPipelineCache::read_file_header(file.data(), file.size(), properties, data_offset, data_size);
+}
+
+TEST(VulkanPipelineCacheTest, FileRoundTripsCacheData) {
+    VkPhysicalDeviceProperties properties = make_device_properties();
+    vector<uint8_t> data = make_cache_data(properties, 100);
+    vector<uint8_t> file = VulkanPipelineCache::make_file(properties, data.data(), data.size());
+
+    size_t data_offset = 0;
+    size_t data_size = 0;
+    ASSERT_TRUE(VulkanPipelineCache::read_file_header(file.data(), file.size(), properties, data_offset, data_size));
+    ASSERT_EQ(data.size(), data_size);
+    EXPECT_EQ(0, memcmp(data.data(), file.data() + data_offset, data_size));
+}
+
+TEST(VulkanPipelineCacheTest, RejectsAnotherDriverVersion) {
+    VkPhysicalDeviceProperties properties = make_device_properties();
+    vector<uint8_t> data = make_cache_data(properties, 100);
+    vector<uint8_t> file = VulkanPipelineCache::make_file(properties, data.data(), data.size());
+
+    properties.driverVersion += 1;
+    EXPECT_FALSE(read_header(file, properties));
+}
+
+TEST(VulkanPipelineCacheTest, RejectsAnotherDevice) {
+    VkPhysicalDeviceProperties properties = make_device_properties();
+    vector<uint8_t> data = make_cache_data(properties, 100);
+    vector<uint8_t> file = VulkanPipelineCache::make_file(properties, data.data(), data.size());
+
+    VkPhysicalDeviceProperties other_uuid = properties;
+    other_uuid.pipelineCacheUUID[3] ^= 0xff;
+    EXPECT_FALSE(read_header(file, other_uuid));
+
+    VkPhysicalDeviceProperties other_device = properties;
+    other_device.deviceID += 1;
+    EXPECT_FALSE(read_header(file, other_device));
+}
+
+TEST(VulkanPipelineCacheTest, RejectsMismatchedVulkanHeader) {
+    VkPhysicalDeviceProperties properties = make_device_properties();
+    vector<uint8_t> data = make_cache_data(properties, 100);
+
+    // The driver data claims another UUID than the one recorded in the file header.
+    data[16] ^= 0xff;
+    vector<uint8_t> file = VulkanPipelineCache::make_file(properties, data.data(), data.size());
+    EXPECT_FALSE(read_header(file, properties));
+}
+
+TEST(VulkanPipelineCacheTest, RejectsDamagedFiles) {
+    VkPhysicalDeviceProperties properties = make_device_properties();
+    vector<uint8_t> data = make_cache_data(properties, 100);
+    vector<uint8_t> file = VulkanPipelineCache::make_file(properties, data.data(), data.size());
+
+    vector<uint8_t> truncated(file.begin(), file.end() - 1);
+    EXPECT_FALSE(read_header(truncated, properties));
+
+    vector<uint8_t> header_only(file.begin(), file.begin() + 8);
+    EXPECT_FALSE(read_header(header_only, properties));
+
+    EXPECT_FALSE(read_header(vector<uint8_t>(), properties));
+
+    vector<uint8_t> bad_magic = file;
+    bad_magic[0] ^= 0xff;
+    EXPECT_FALSE(read_header(bad_magic, properties));
+
+    // Data too short to hold the Vulkan header.
+    vector<uint8_t> short_data(8, 0);
+    vector<uint8_t> short_file = VulkanPipelineCache::make_file(properties, short_data.data(), short_data.size());
+    EXPECT_FALSE(read_header(short_file, properties));
+}
@@ -275,12 +275,6 @@ public:
         //
         PipelineCreateParameters colored_pipeline_params = {};
         array<const Shader *, 2> colored_shaders = {_colored_shader_v.get(), _colored_shader_f.get()};
-        colored_pipeline_params.viewport.width = 512;
-        colored_pipeline_params.viewport.height = 512;
-        colored_pipeline_params.viewport.min_depth = 0;
-        colored_pipeline_params.viewport.min_depth = 1;
-        colored_pipeline_params.scissor.width = 512;
-        colored_pipeline_params.scissor.height = 512;
         colored_pipeline_params.shader_count = 2;
         colored_pipeline_params.shaders = colored_shaders.data();
         colored_pipeline_params.vertex_buffer_layout_count = 1;
@@ -292,12 +286,6 @@ public:
 
         PipelineCreateParameters textured_pipeline_params = {};
         array<const Shader *, 2> textured_shaders = {_textured_shader_v.get(), _textured_shader_f.get()};
-        textured_pipeline_params.viewport.width = _renderer->swapchain()->width();
-        textured_pipeline_params.viewport.height = _renderer->swapchain()->height();
-        textured_pipeline_params.viewport.min_depth = 0;
-        textured_pipeline_params.viewport.min_depth = 1;
-        textured_pipeline_params.scissor.width = _renderer->swapchain()->width();
-        textured_pipeline_params.scissor.height = _renderer->swapchain()->height();
         textured_pipeline_params.shader_count = 2;
         textured_pipeline_params.shaders = textured_shaders.data();
         textured_pipeline_params.vertex_buffer_layout_count = 1;
@@ -343,7 +331,7 @@ public:
         _onscreen_uniforms->set_data(0, reinterpret_cast<const uint8_t *>(&onscreen_uniforms), sizeof(onscreen_uniforms));
 
 
-        array<PassSubmissionInfo, 2> passes;
+        array<PassSubmissionInfo, 2> passes = {};
         PassSubmissionInfo &offscreen_pass_info = passes[0];
         PassSubmissionInfo &onscreen_pass_info = passes[1];
 
@@ -134,12 +134,6 @@ public:
         //
         PipelineCreateParameters pipeline_params = {};
         array<const Shader *, 2> textured_shaders = {_vs.get(), _fs.get()};
-        pipeline_params.viewport.width = _renderer->swapchain()->width();
-        pipeline_params.viewport.height = _renderer->swapchain()->height();
-        pipeline_params.viewport.min_depth = 0;
-        pipeline_params.viewport.min_depth = 1;
-        pipeline_params.scissor.width = _renderer->swapchain()->width();
-        pipeline_params.scissor.height = _renderer->swapchain()->height();
         pipeline_params.shader_count = 2;
         pipeline_params.shaders = textured_shaders.data();
         pipeline_params.vertex_buffer_layout_count = 1;
@@ -113,12 +113,6 @@ public:
         //
         array<const Shader *, 2> shaders = {_vertex_shader.get(), _fragment_shader.get()};
         PipelineCreateParameters pipeline_params = {};
-        pipeline_params.viewport.width = _renderer->swapchain()->width();
-        pipeline_params.viewport.height = _renderer->swapchain()->height();
-        pipeline_params.viewport.min_depth = 0;
-        pipeline_params.viewport.min_depth = 1;
-        pipeline_params.scissor.width = _renderer->swapchain()->width();
-        pipeline_params.scissor.height = _renderer->swapchain()->height();
         pipeline_params.shader_count = 2;
         pipeline_params.shaders = shaders.data();
         pipeline_params.vertex_buffer_layout_count = 1;
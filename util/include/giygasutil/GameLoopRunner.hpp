@@ -1,6 +1,7 @@
 #pragma once
 #include <giygasutil/export.h>
 #include <giygas/Context.hpp>
+#include <giygas/Renderer.hpp>
 #include "GameLoopDelegate.hpp"
 
 namespace giygas {
@@ -8,6 +9,7 @@ namespace giygas {
     class GIYGASUTIL_EXPORT GameLoopRunner {
         Context *_context;
         GameLoopDelegate *_updatable;
+        Renderer *_renderer;
     public:
         GameLoopRunner(
             Context *context,
@@ -15,6 +17,10 @@ namespace giygas {
         );
         void set_context(Context *context);
         void set_updatable(GameLoopDelegate *updatable);
+
+        // Optional. When set, the runner waits for the renderer's next frame before running game logic, which is
+        // needed for renderers initialized in low latency mode.
+        void set_renderer(Renderer *renderer);
         void run();
     };
 
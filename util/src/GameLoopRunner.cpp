@@ -15,6 +15,7 @@ GameLoopRunner::GameLoopRunner(
 ) {
     _context = context;
     _updatable = updatable;
+    _renderer = nullptr;
 }
 
 void GameLoopRunner::set_context(Context *context) {
@@ -25,6 +26,10 @@ void GameLoopRunner::set_updatable(GameLoopDelegate *updatable) {
     _updatable = updatable;
 }
 
+void GameLoopRunner::set_renderer(Renderer *renderer) {
+    _renderer = renderer;
+}
+
 void GameLoopRunner::run() {
     typedef duration<long long, ratio<1, 60>> Frames;
     typedef duration<float> FSeconds;
@@ -35,6 +40,9 @@ void GameLoopRunner::run() {
 
     for (;;) {
         float elapsed_seconds = duration_cast<FSeconds>(frame_start - previous_frame_start).count();
+        if (_renderer != nullptr) {
+            _renderer->wait_for_next_frame();
+        }
         _context->update();
         _updatable->update_logic(elapsed_seconds);
         _updatable->update_graphics();